@@ -32,6 +32,81 @@ namespace ssd1306
 
 const std::size_t char_map_size {95};
 
+constexpr uint8_t font5x5_width {5};
+constexpr uint8_t font5x7_width {5};
+constexpr uint8_t font7x10_width {7};
+constexpr uint8_t font11x18_width {11};
+constexpr uint8_t font16x26_width {16};
+
+constexpr uint8_t font5x5_height {5};
+constexpr uint8_t font5x7_height {7};
+constexpr uint8_t font7x10_height {10};
+constexpr uint8_t font11x18_height {18};
+constexpr uint8_t font16x26_height {26};
+
+// @brief Marks a character that has no glyph in a character set
+constexpr uint8_t no_glyph {0xFF};
+
+// @brief Build the lookup table from 7-bit character code to glyph position for a character set.
+// Only used at compile time. Characters that are not in the set map to no_glyph.
+// @tparam GLYPH_COUNT The number of glyphs in the character set, at most 255
+// @param character_map The characters, in font data order. Must be 7-bit ASCII.
+// @return the glyph index table, indexed by character code
+template<std::size_t GLYPH_COUNT>
+constexpr std::array<uint8_t, 128> make_glyph_index(const std::array<char, GLYPH_COUNT> &character_map)
+{
+	static_assert(GLYPH_COUNT < no_glyph, "Character sets are limited to 255 glyphs");
+	std::array<uint8_t, 128> glyph_index{};
+	glyph_index.fill(no_glyph);
+	for (std::size_t glyph_idx = 0; glyph_idx < GLYPH_COUNT; glyph_idx++)
+	{
+		glyph_index[static_cast<unsigned char>(character_map[glyph_idx]) & 0x7F] = static_cast<uint8_t>(glyph_idx);
+	}
+	return glyph_index;
+}
+
+// @brief The printable ASCII character set of the built-in fonts.
+// Font traits inherit a character set, so fonts sharing a set also share its glyph index table.
+// A font that only contains some characters, e.g. digits, declares its own set with the same two members.
+struct AsciiCharacterSet
+{
+	// @brief The characters in the font, in font data order
+	static constexpr std::array<char, char_map_size> character_map {
+		' ', '!', '"', '#', '$', '%', '&', '\'','(', ')',
+		'*', '+', ',', '-', '.', '/', '0', '1', '2', '3',
+		'4', '5', '6', '7', '8', '9', ':', ';', '<', '=',
+		'>', '?', '@', 'A', 'B', 'C', 'D', 'E', 'F', 'G',
+		'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P', 'Q',
+		'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z', '[',
+		'\\',']', '^', '_', '`', 'a', 'b', 'c', 'd', 'e',
+		'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o',
+		'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y',
+		'z', '{', '|', '}', '~'
+	};
+
+	// @brief The glyph position of each character code, see make_glyph_index()
+	static constexpr std::array<uint8_t, 128> glyph_index{make_glyph_index(character_map)};
+};
+
+// @brief Compile-time dimensions and character set of the font selected by FONT_SIZE
+// @tparam FONT_SIZE The size of the font data
+template<std::size_t FONT_SIZE>
+struct FontTraits;
+
+template<> struct FontTraits<font5x5_height * char_map_size> 	: AsciiCharacterSet { static constexpr uint8_t width{font5x5_width}; 	static constexpr uint8_t height{font5x5_height}; };
+template<> struct FontTraits<font5x7_height * char_map_size> 	: AsciiCharacterSet { static constexpr uint8_t width{font5x7_width}; 	static constexpr uint8_t height{font5x7_height}; };
+template<> struct FontTraits<font7x10_height * char_map_size> 	: AsciiCharacterSet { static constexpr uint8_t width{font7x10_width}; 	static constexpr uint8_t height{font7x10_height}; };
+template<> struct FontTraits<font11x18_height * char_map_size> 	: AsciiCharacterSet { static constexpr uint8_t width{font11x18_width}; 	static constexpr uint8_t height{font11x18_height}; };
+template<> struct FontTraits<font16x26_height * char_map_size> 	: AsciiCharacterSet { static constexpr uint8_t width{font16x26_width}; 	static constexpr uint8_t height{font16x26_height}; };
+
+template<std::size_t FONT_SIZE>
+class FontPacked;
+
+template<std::size_t FONT_SIZE>
+class ProportionalFont;
+
+// @brief A fixed width font. All font data is static and const so it is linked into flash only;
+// Font objects hold no state and are just handles used to select the font.
 template<std::size_t FONT_SIZE>
 class Font
 {
@@ -39,14 +114,14 @@ class Font
 public:
 
 	// @brief Construct a new Font object
-	Font() = default;
+	constexpr Font() = default;
 
 	// @brief function to get a font pixel (16bit half-word).
 	// @param idx The position in the font data array to retrieve data
 	// @return uint16_t The halfword of data we retrieve
-	bool get_pixel(std::size_t idx, uint32_t &bit_line)
+	static bool get_pixel(std::size_t idx, uint32_t &bit_line)
 	{ 
-		if (idx > data.size())
+		if (idx >= data.size())
 		{
 			return false;
 		}
@@ -62,47 +137,296 @@ public:
 
 	// @brief get the width member variable 
 	// @return uint8_t the width value
-	uint8_t width() { return m_width; }
+	static constexpr uint8_t width() { return m_width; }
 
 	// @brief get tte height member variable 
 	// @return uint8_t the height value
-	uint8_t height() { return m_height; }
+	static constexpr uint8_t height() { return m_height; }
 
 	// @brief helper function to get the size of the private font data array.
 	// @return size_t the array size
-	std::size_t size() { return data.size(); }
+	static constexpr std::size_t size() { return FONT_SIZE; }
 
-	std::array<char, char_map_size> character_map {
-		' ', '!', '"', '#', '$', '%', '&', '\'','(', ')',
-		'*', '+', ',', '-', '.', '/', '0', '1', '2', '3',
-		'4', '5', '6', '7', '8', '9', ':', ';', '<', '=',
-		'>', '?', '@', 'A', 'B', 'C', 'D', 'E', 'F', 'G',
-		'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P', 'Q',
-		'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z', '[',
-		'\\',']', '^', '_', '`', 'a', 'b', 'c', 'd', 'e',
-		'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o',
-		'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y',
-		'z', '{', '|', '}', '~'
-	};
+	// @brief get the width of a glyph. Part of the glyph interface used by CommonFunctions::write_char.
+	// @return uint8_t the width value, the same for every glyph
+	static constexpr uint8_t glyph_width(std::size_t) { return m_width; }
+
+	// @brief get the horizontal distance from the start of a glyph to the start of the next glyph
+	// @return uint8_t the advance value, the same for every glyph
+	static constexpr uint8_t glyph_advance(std::size_t) { return m_width; }
+
+	// @brief get one column of a glyph. Unchecked, see glyph_index().
+	// @param glyph_idx The glyph position in the character map
+	// @param col The column within the glyph, 0 is the leftmost
+	// @return uint32_t the column pixels, LSB is the top row
+	static uint32_t column(std::size_t glyph_idx, uint8_t col) { return FontPacked<FONT_SIZE>::column(glyph_idx, col); }
+
+	// @brief get the spacing adjustment between two characters
+	// @return int8_t always 0, fixed width fonts are not kerned
+	static constexpr int8_t kerning(char, char) { return 0; }
+
+	// @brief find the glyph of a character. This is the only range check when rendering a glyph;
+	// glyph_width(), glyph_advance() and column() do not check their glyph_idx.
+	// @param ch The character
+	// @return std::size_t the glyph position in the font data, or no_glyph if the font has no glyph for the character
+	static constexpr std::size_t glyph_index(char ch)
+	{
+		const auto code = static_cast<unsigned char>(ch);
+		return (code < FontTraits<FONT_SIZE>::glyph_index.size()) ? FontTraits<FONT_SIZE>::glyph_index[code] : no_glyph;
+	}
+
+	// @brief The characters in the font, in font data order
+	static constexpr const auto &character_map{FontTraits<FONT_SIZE>::character_map};
+
+	// @brief The number of glyphs in the font
+	static constexpr std::size_t m_glyph_count{FontTraits<FONT_SIZE>::character_map.size()};
 
 private:
 
+	// @brief the packed copy and the proportional glyph metrics are generated from the font data
+	friend class FontPacked<FONT_SIZE>;
+	friend class ProportionalFont<FONT_SIZE>;
+
 	// @brief The width of the font in pixels
-	static const uint8_t m_width; 
+	static constexpr uint8_t m_width{FontTraits<FONT_SIZE>::width}; 
 
 	// @brief The height of the font in pixels
-	static const uint8_t m_height;
+	static constexpr uint8_t m_height{FontTraits<FONT_SIZE>::height};
 
-	// @brief the font data
-	static std::array<uint16_t, FONT_SIZE> data;
+	// @brief the font data, one halfword per row. Only the m_width MSB of each halfword are used, 1 bit per col.
+	static const std::array<uint16_t, FONT_SIZE> data;
 
 };
 
-constexpr uint8_t font5x5_height {5};
-constexpr uint8_t font5x7_height {7};
-constexpr uint8_t font7x10_height {10};
-constexpr uint8_t font11x18_height {18};
-constexpr uint8_t font16x26_height {26};
+// @brief Describes the layout of a packed font table
+struct FontMetrics
+{
+	// @brief The width of each glyph in pixels
+	uint8_t width;
+	// @brief The height of each glyph in pixels. Also the number of bits per glyph column.
+	uint8_t height;
+	// @brief The character of the first glyph in the table
+	char first_char;
+	// @brief The number of glyphs in the table
+	uint8_t glyph_count;
+	// @brief The number of bytes per glyph. Glyphs start on a byte boundary.
+	uint8_t glyph_size;
+};
+
+// @brief Column-major, bit-packed copy of a Font, generated at compile time from the row-major Font data.
+// Each glyph is stored as m_width columns of exactly m_height bits, back to back with no padding,
+// so no bits are wasted on the unused LSB of the Font data halfwords. Within a column the LSB is the top row,
+// the same vertical order as the SSD1306 GDDRAM, so a decoded column can be written to the display buffer directly.
+// @tparam FONT_SIZE The size of the source Font data
+template<std::size_t FONT_SIZE>
+class FontPacked
+{
+public:
+
+	// @brief The width of the font in pixels
+	static constexpr uint8_t m_width{FontTraits<FONT_SIZE>::width};
+
+	// @brief The height of the font in pixels
+	static constexpr uint8_t m_height{FontTraits<FONT_SIZE>::height};
+
+	// @brief The number of bytes per glyph. Glyph glyph_idx starts at byte glyph_idx * m_glyph_size.
+	static constexpr std::size_t m_glyph_size{(m_width * m_height + 7) / 8};
+
+	// @brief The number of glyphs in the font
+	static constexpr std::size_t m_glyph_count{Font<FONT_SIZE>::m_glyph_count};
+
+	// @brief The metrics header describing the packed data
+	static constexpr FontMetrics m_metrics{m_width, m_height, Font<FONT_SIZE>::character_map[0], m_glyph_count, m_glyph_size};
+
+	// @brief Get one column of a glyph as a bit line. Unchecked, see Font::glyph_index().
+	// @param glyph_idx The glyph position in the character map
+	// @param col The column within the glyph, 0 is the leftmost
+	// @return uint32_t the column pixels, LSB is the top row
+	static uint32_t column(std::size_t glyph_idx, uint8_t col)
+	{
+		const std::size_t bit_pos = col * m_height;
+		std::size_t pos = glyph_idx * m_glyph_size + bit_pos / 8;
+
+		// a column spans at most 5 bytes; bits beyond m_height are masked off below
+		uint32_t bit_line = data[pos] >> (bit_pos % 8);
+		for (uint8_t bits_read = 8 - (bit_pos % 8); bits_read < m_height; bits_read += 8)
+		{
+			bit_line |= static_cast<uint32_t>(data[++pos]) << bits_read;
+		}
+		return bit_line & ((1ULL << m_height) - 1);
+	}
+
+	// @brief Pack the row-major Font data into columns. Only used at compile time to initialise data.
+	// @param rows The Font data
+	// @return the packed font data
+	static constexpr std::array<uint8_t, m_glyph_size * m_glyph_count> pack(const std::array<uint16_t, FONT_SIZE> &rows)
+	{
+		std::array<uint8_t, m_glyph_size * m_glyph_count> packed{};
+		for (std::size_t glyph_idx = 0; glyph_idx < m_glyph_count; glyph_idx++)
+		{
+			for (uint8_t row = 0; row < m_height; row++)
+			{
+				const uint16_t bit_line = rows[glyph_idx * m_height + row];
+				for (uint8_t col = 0; col < m_width; col++)
+				{
+					if ((bit_line << col) & 0x8000)
+					{
+						const std::size_t bit_pos = col * m_height + row;
+						packed[glyph_idx * m_glyph_size + bit_pos / 8] |= static_cast<uint8_t>(1U << (bit_pos % 8));
+					}
+				}
+			}
+		}
+		return packed;
+	}
+
+	// @brief the packed font data
+	static const std::array<uint8_t, m_glyph_size * m_glyph_count> data;
+};
+
+// @brief The inked column range of one glyph of a ProportionalFont
+struct GlyphMetrics
+{
+	// @brief The first inked column in the fixed width glyph
+	uint8_t offset;
+	// @brief The number of columns from the first to the last inked column
+	uint8_t width;
+};
+
+// @brief Adjusts the spacing between two characters of a ProportionalFont
+struct KerningPair
+{
+	// @brief The first character
+	char left;
+	// @brief The character following it
+	char right;
+	// @brief The change in spacing in pixels. Negative values move the characters closer.
+	int8_t adjust;
+};
+
+// @brief A variable width version of a fixed width Font.
+// The blank columns either side of each glyph are trimmed, measured at compile time from the Font data, and the glyph
+// pixels are read from the same FontPacked table as the fixed width font, so only the 2 byte GlyphMetrics per glyph are added.
+// Glyphs are followed by m_spacing background columns. Blank glyphs like space are half the font width.
+// An optional kerning table can be passed to the constructor; the font object then holds a reference to that table.
+// @tparam FONT_SIZE The size of the source Font data
+template<std::size_t FONT_SIZE>
+class ProportionalFont
+{
+public:
+
+	// @brief Construct a new ProportionalFont object without kerning
+	constexpr ProportionalFont() = default;
+
+	// @brief Construct a new ProportionalFont object with kerning
+	// @tparam KERNING_SIZE The number of kerning pairs
+	// @param kerning The kerning pairs. Must outlive the font object.
+	template<std::size_t KERNING_SIZE>
+	constexpr explicit ProportionalFont(const std::array<KerningPair, KERNING_SIZE> &kerning)
+	: m_kerning(kerning.data()), m_kerning_size(KERNING_SIZE)
+	{
+	}
+
+	// @brief The number of background columns between glyphs
+	static constexpr uint8_t m_spacing{1};
+
+	// @brief get the height of the font
+	// @return uint8_t the height value
+	static constexpr uint8_t height() { return FontTraits<FONT_SIZE>::height; }
+
+	// @brief find the glyph of a character, see Font::glyph_index()
+	// @param ch The character
+	// @return std::size_t the glyph position, or no_glyph if the font has no glyph for the character
+	static constexpr std::size_t glyph_index(char ch) { return Font<FONT_SIZE>::glyph_index(ch); }
+
+	// @brief The number of glyphs in the font
+	static constexpr std::size_t m_glyph_count{Font<FONT_SIZE>::m_glyph_count};
+
+	// @brief get the inked width of a glyph
+	// @param glyph_idx The glyph position in the character map
+	// @return uint8_t the width value
+	static uint8_t glyph_width(std::size_t glyph_idx) { return m_glyphs[glyph_idx].width; }
+
+	// @brief get the horizontal distance from the start of a glyph to the start of the next glyph
+	// @param glyph_idx The glyph position in the character map
+	// @return uint8_t the advance value
+	static uint8_t glyph_advance(std::size_t glyph_idx) { return m_glyphs[glyph_idx].width + m_spacing; }
+
+	// @brief get one inked column of a glyph
+	// @param glyph_idx The glyph position in the character map
+	// @param col The column within the inked width, 0 is the leftmost
+	// @return uint32_t the column pixels, LSB is the top row
+	static uint32_t column(std::size_t glyph_idx, uint8_t col)
+	{
+		return FontPacked<FONT_SIZE>::column(glyph_idx, m_glyphs[glyph_idx].offset + col);
+	}
+
+	// @brief get the spacing adjustment between two characters
+	// @param left The first character
+	// @param right The character following it
+	// @return int8_t the adjustment in pixels, 0 if the pair is not in the kerning table
+	int8_t kerning(char left, char right) const
+	{
+		for (std::size_t idx = 0; idx < m_kerning_size; idx++)
+		{
+			if (m_kerning[idx].left == left && m_kerning[idx].right == right)
+			{
+				return m_kerning[idx].adjust;
+			}
+		}
+		return 0;
+	}
+
+	// @brief Measure the inked columns of each glyph of the row-major Font data. Only used at compile time to initialise m_glyphs.
+	// @param rows The Font data
+	// @return the glyph metrics
+	static constexpr std::array<GlyphMetrics, m_glyph_count> measure(const std::array<uint16_t, FONT_SIZE> &rows)
+	{
+		constexpr uint8_t width = FontTraits<FONT_SIZE>::width;
+		constexpr uint8_t font_height = FontTraits<FONT_SIZE>::height;
+		std::array<GlyphMetrics, m_glyph_count> glyphs{};
+		for (std::size_t glyph_idx = 0; glyph_idx < m_glyph_count; glyph_idx++)
+		{
+			// any pixel in a column marks it as inked, ignoring the unused LSB
+			uint16_t inked_cols{0};
+			for (uint8_t row = 0; row < font_height; row++)
+			{
+				inked_cols |= rows[glyph_idx * font_height + row];
+			}
+			inked_cols &= static_cast<uint16_t>(0xFFFF << (16 - width));
+
+			if (inked_cols == 0)
+			{
+				glyphs[glyph_idx] = GlyphMetrics{0, static_cast<uint8_t>(width / 2)};
+				continue;
+			}
+
+			uint8_t first_col{0};
+			while (!((inked_cols << first_col) & 0x8000))
+			{
+				first_col++;
+			}
+			uint8_t last_col{static_cast<uint8_t>(width - 1)};
+			while (!((inked_cols << last_col) & 0x8000))
+			{
+				last_col--;
+			}
+			glyphs[glyph_idx] = GlyphMetrics{first_col, static_cast<uint8_t>(last_col - first_col + 1)};
+		}
+		return glyphs;
+	}
+
+	// @brief The inked column range of each glyph
+	static const std::array<GlyphMetrics, m_glyph_count> m_glyphs;
+
+private:
+
+	// @brief The kerning pairs, or nullptr
+	const KerningPair *m_kerning{nullptr};
+
+	// @brief The number of kerning pairs
+	std::size_t m_kerning_size{0};
+};
 
 // the template class object sizes only contribute to your program size if they are used; otherwise they are not linked
 using Font5x5 	= 	Font<font5x5_height * char_map_size>;		// 15408 bytes
@@ -111,6 +435,20 @@ using Font7x10 	= 	Font<font7x10_height * char_map_size>;		// 16364 bytes
 using Font11x18 = 	Font<font11x18_height * char_map_size>;		// 17936 bytes
 using Font16x26 = 	Font<font16x26_height * char_map_size>;		// 19456 bytes
 
+// the packed copies used for rendering
+using Font5x5Packed 	= 	FontPacked<font5x5_height * char_map_size>;		// 380 bytes
+using Font5x7Packed 	= 	FontPacked<font5x7_height * char_map_size>;		// 475 bytes
+using Font7x10Packed 	= 	FontPacked<font7x10_height * char_map_size>;	// 855 bytes
+using Font11x18Packed 	= 	FontPacked<font11x18_height * char_map_size>;	// 2375 bytes
+using Font16x26Packed 	= 	FontPacked<font16x26_height * char_map_size>;	// 4940 bytes
+
+// variable width versions of the fixed width fonts, 190 bytes each plus the packed font
+using Font5x5Proportional 	= 	ProportionalFont<font5x5_height * char_map_size>;
+using Font5x7Proportional 	= 	ProportionalFont<font5x7_height * char_map_size>;
+using Font7x10Proportional 	= 	ProportionalFont<font7x10_height * char_map_size>;
+using Font11x18Proportional = 	ProportionalFont<font11x18_height * char_map_size>;
+using Font16x26Proportional = 	ProportionalFont<font16x26_height * char_map_size>;
+
 } // namespace ssd1306
 
 #endif // __FONT_HPP__
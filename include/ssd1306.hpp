@@ -26,257 +26,549 @@
 #ifndef __SSD1306_HPP_
 #define __SSD1306_HPP_
 
+#include <atomic>
 #include <cstring>
-#include <ssd1306_device.hpp>
+#include <ssd1306_bus_trace.hpp>
+#include <ssd1306_critical_section.hpp>
+#include <ssd1306_transport.hpp>
 #include <timer_manager.hpp>
 
 namespace ssd1306
 {
 
+// @brief The ways update_screen() can send the modified areas of the sw buffer
+enum class UpdateStrategy
+{
+  // @brief nothing was modified
+  none,
+  // @brief one DMA transfer of the whole sw buffer
+  full_frame,
+  // @brief one update_region() of the rectangle around all modified areas
+  window,
+  // @brief each modified page span is sent on its own, by the CPU
+  pages
+};
+
+// @brief The update chosen by Driver::plan_update() and its predicted cost
+struct UpdatePlan
+{
+  UpdateStrategy strategy{UpdateStrategy::none};
+  // @brief The rectangle sent by UpdateStrategy::window: first/last column and first/last page
+  uint8_t x0{0};
+  uint8_t page0{0};
+  uint8_t x1{0};
+  uint8_t page1{0};
+  // @brief The number of command bytes that will be sent
+  uint16_t command_bytes{0};
+  // @brief The number of data bytes that will be sent
+  uint16_t data_bytes{0};
+  // @brief The number of separate DMA transfers or page writes
+  uint8_t transfers{0};
+
+  // @brief The predicted number of bytes on the wire
+  uint16_t predicted_bytes() const { return command_bytes + data_bytes; }
+};
+
+// @brief The SSD1306 register values the driver changes after the power on sequence, as last sent.
+// Starts at the IC reset values. Commands that would not change a register are not sent.
+struct ControllerState
+{
+  // @brief Marks an address pointer or window position that is not known
+  static constexpr uint8_t unknown{0xFF};
+
+  // @brief The GDDRAM page of the Page Addressing Mode address pointer
+  uint8_t page{unknown};
+  // @brief The GDDRAM column of the Page Addressing Mode address pointer
+  uint8_t column{unknown};
+
+  // @brief The Horizontal Addressing Mode window, in GDDRAM columns and pages. Transfers always fill the window
+  // exactly, so the address pointer is back at the start of the window after each transfer.
+  uint8_t window_first_col{unknown};
+  uint8_t window_last_col{unknown};
+  uint8_t window_first_page{unknown};
+  uint8_t window_last_page{unknown};
+
+  // @brief The contrast setting
+  uint8_t contrast{0x7F};
+  // @brief Inverse display
+  bool inverse{false};
+  // @brief Driver on in normal mode, otherwise sleep mode
+  bool display_on{false};
+
+  // @brief Horizontal scrolling is active
+  bool scrolling{false};
+  // @brief The scroll setup command, 0x26 right or 0x27 left
+  uint8_t scroll_direction{unknown};
+  // @brief The first and last scrolled page
+  uint8_t scroll_first_page{unknown};
+  uint8_t scroll_last_page{unknown};
+  // @brief The scroll step interval setting
+  uint8_t scroll_interval{unknown};
+};
+
 // @brief
-template <typename DEVICE_ISR_ENUM>
-class Driver : public RestrictedBase, public CommonFunctions
+// @tparam DEVICE_ISR_ENUM The interrupt type enum of the MCU, see stm32_interrupt_managers
+// @tparam GEOMETRY The panel resolution, see Geometry
+// @tparam FRAMEBUFFER_COUNT 2 for double or 3 for triple buffering with SPIDMA::enabled, see present()
+// @tparam TRANSPORT The bus, see ssd1306_transport.hpp
+template <typename DEVICE_ISR_ENUM, typename GEOMETRY = Geometry128x64, std::size_t FRAMEBUFFER_COUNT = 1, typename TRANSPORT = SpiTransport<DEVICE_ISR_ENUM>>
+class Driver : public RestrictedBase, public CommonFunctions<GEOMETRY, FRAMEBUFFER_COUNT>
 {
+  using Common = CommonFunctions<GEOMETRY, FRAMEBUFFER_COUNT>;
+  using Common::m_framebuffers;
+
 public:
+  using typename Common::DirtySpan;
+  using Common::clear_dirty;
+  using Common::dirty_span;
+  using Common::fill;
+  using Common::is_dirty;
+  using Common::m_buffer;
+  using Common::m_currentx;
+  using Common::m_currenty;
+  using Common::m_page_count;
+  using Common::m_page_width;
+  using Common::set_cursor;
+
   enum class SPIDMA
   {
     disabled,
-    enabled
+    enabled,
+    // @brief No DMA: the SPI TXE interrupt streams the pages, see spi_isr(). Single sw buffer only.
+    interrupt,
+    // @brief DMA in Page Addressing Mode: one DMA transfer per page, the DMA ISR addresses the next page.
+    // For page-only controllers and page granular updates. Single sw buffer only.
+    paged
   };
 
   // @brief Stored setting for enabling/disabling DMA
   SPIDMA spi_dma_setting{SPIDMA::disabled};
 
-  Driver(const DriverSerialInterface<DEVICE_ISR_ENUM> &display_spi_interface, SPIDMA dma_option)
-      : spi_dma_setting(dma_option),
-        m_serial_interface(display_spi_interface)
+  // @brief Called from the DMA ISR when a frame transfer completes
+  // @param context The pointer passed to set_transfer_complete_callback()
+  using TransferCompleteCallback = void (*)(void *context);
+
+  // @brief Construct a new Driver object
+  // @param transport The bus, e.g. a DriverSerialInterface for SPI
+  // @param dma_option The transfer mode. Transports without SPI only support SPIDMA::disabled. With double or triple
+  // buffering SPIDMA::interrupt and SPIDMA::paged become SPIDMA::enabled, see present().
+  Driver(const TRANSPORT &transport, SPIDMA dma_option)
+      : spi_dma_setting(supported_mode(dma_option)),
+        m_transport(transport)
   {
+#if defined(SSD1306_BUS_STATISTICS)
+    if constexpr (requires(TRANSPORT &bus, BusCounters *counters) { bus.attach_counters(counters); })
+    {
+      m_transport.attach_counters(&m_counters);
+    }
+#endif
   }
 
   // @brief write setup commands to the IC
   bool power_on_sequence()
   {
-    stm32::spi_ref::enable_spi(m_serial_interface.get_spi_handle());
+    m_transport.begin();
+    trace::enable_clock();
 
     reset();
 
     // Now wait for the screen to boot
     stm32::delay_millisecond(10);
 
-    // put into sleep mode during setup, probably not needed
-    if (!send_command(static_cast<uint8_t>(fcmd::display_mode_sleep)))
+    // put into sleep mode during setup and set the fundamental, hardware config and timing commands
+    if (!send_commands(m_init_commands))
     {
       return false;
     }
 
-    // set fundamental commands
-    if (!send_command(static_cast<uint8_t>(fcmd::display_use_ram)))
-    {
-      return false;
-    }
-    if (!send_command(static_cast<uint8_t>(fcmd::display_inverse_off)))
-    {
-      return false;
-    }
-    if (!send_command(static_cast<uint8_t>(fcmd::set_display_constrast)))
-    {
-      return false;
-    }
-    if (!send_command(static_cast<uint8_t>(fcmd::max_constrast)))
-    {
-      return false;
-    }
+    m_state.contrast = static_cast<uint8_t>(fcmd::max_constrast);
+    m_state.inverse  = false;
 
+    // DMA uses horizontal addressing mode because commands are not required before every buffer update
     if (spi_dma_setting == SPIDMA::enabled)
     {
-      // set page addressing mode
-      if (!send_command(static_cast<uint8_t>(acmd::set_memory_mode)))
-      {
-        return false;
-      }
-      if (!send_command(static_cast<uint8_t>(acmd::horiz_addr_mode)))
-      {
-        return false;
-      }
-
-      if (!send_command(static_cast<uint8_t>(acmd::set_column_address)))
-      {
-        return false;
-      }
-      if (!send_command(static_cast<uint8_t>(0x00)))
-      {
-        return false;
-      }
-      if (!send_command(static_cast<uint8_t>(0x7F)))
-      {
-        return false;
-      }
-
-      if (!send_command(static_cast<uint8_t>(acmd::set_page_address)))
-      {
-        return false;
-      }
-      if (!send_command(static_cast<uint8_t>(0x00)))
-      {
-        return false;
-      }
-      if (!send_command(static_cast<uint8_t>(0x07)))
+      if (!send_commands(m_horiz_addr_commands))
       {
         return false;
       }
+      m_state.window_first_col  = GEOMETRY::column_offset;
+      m_state.window_last_col   = GEOMETRY::column_offset + GEOMETRY::width - 1;
+      m_state.window_first_page = 0;
+      m_state.window_last_page  = m_page_count - 1;
     }
     else
     {
-      // set horizontal addressing mode - can be used with DMA because commands arenot required before every buffer update
-      if (!send_command(static_cast<uint8_t>(acmd::set_memory_mode)))
-      {
-        return false;
-      }
-      if (!send_command(static_cast<uint8_t>(acmd::page_addr_mode)))
-      {
-        return false;
-      }
-      if (!send_command(static_cast<uint8_t>(acmd::start_page_0)))
-      {
-        return false;
-      }
-      if (!send_command(static_cast<uint8_t>(acmd::start_lcol_0)))
-      {
-        return false;
-      }
-      if (!send_command(static_cast<uint8_t>(acmd::start_hcol_0)))
+      if (!send_commands(m_page_addr_commands))
       {
         return false;
       }
+      m_state.page   = 0;
+      m_state.column = GEOMETRY::column_offset;
     }
 
-    // set hardware config commands
-    if (!send_command(static_cast<uint8_t>(hwcmd::start_line_0)))
+    // wake up display
+    if (!send_command(static_cast<uint8_t>(fcmd::display_mode_normal)))
     {
       return false;
     }
-    if (!send_command(static_cast<uint8_t>(hwcmd::vert_flip_normal)))
+    m_state.display_on = true;
+
+    // Clear screen
+    fill(Colour::Black);
+
+    if constexpr (TRANSPORT::spi_capable)
     {
-      return false;
+#if not defined(X86_UNIT_TESTING_ONLY)
+      if (spi_dma_setting == SPIDMA::enabled || spi_dma_setting == SPIDMA::paged)
+      {
+        DriverSerialInterface<DEVICE_ISR_ENUM> &serial_interface = m_transport.serial_interface();
+        // setup the SPI DMA. The channel is only enabled by begin_frame_transfer()
+        stm32::spi_ref::enable_spi(serial_interface.get_spi_handle(), false);
+
+        // cppcheck-suppress cstyleCast - CMSIS limitation
+        LL_DMA_DisableChannel(DMA1, LL_DMA_CHANNEL_1);
+        // cppcheck-suppress cstyleCast - CMSIS limitation
+        LL_DMA_SetMode(DMA1, LL_DMA_CHANNEL_1, LL_DMA_MODE_NORMAL);
+        // cppcheck-suppress cstyleCast - CMSIS limitation
+        LL_DMA_SetPeriphAddress(DMA1, LL_DMA_CHANNEL_1, (uint32_t)&serial_interface.get_spi_handle().DR);
+        // cppcheck-suppress cstyleCast - CMSIS limitation
+        LL_DMA_EnableIT_TC(DMA1, LL_DMA_CHANNEL_1);
+
+        serial_interface.get_spi_handle().CR2 = serial_interface.get_spi_handle().CR2 | SPI_CR2_TXDMAEN;
+        stm32::spi_ref::enable_spi(serial_interface.get_spi_handle());
+      }
+#endif
     }
-    if (!send_command(static_cast<uint8_t>(hwcmd::horiz_flip_normal)))
+
+    // Flush buffer to screen
+    ErrorStatus res = update_screen();
+    if (res != ErrorStatus::OK)
     {
       return false;
     }
-    if (!send_command(static_cast<uint8_t>(hwcmd::set_mux_ratio)))
+
+    // Set default values for screen object
+    m_currentx = 0;
+    m_currenty = 0;
+
+    return true;
+  }
+
+  // @brief Convenience function to write msg to the display.
+  // @tparam FONT The font type, Uses template argument deduction.
+  // @param msg The message to display
+  // @param font The font size object: Font5x5, Font5x7, Font7x10, Font11x18, Font16x26,
+  // or a variable width version of them e.g. Font5x7Proportional
+  // @param x pos
+  // @param y pos
+  // @param bg The background colour
+  // @param fg The foreground colour
+  // @param padding add an extra pixel to the vertical edge of the character. Disables kerning.
+  // @param update write the sw buffer to the IC
+  // @return ErrorStatus
+
+  template <typename FONT, std::size_t MSG_SIZE>
+  ErrorStatus write(
+      noarch::containers::StaticString<MSG_SIZE> &msg, const FONT &font, uint8_t x, uint8_t y, Colour bg, Colour fg, bool padding, bool update);
+
+  // @brief Start sending the whole front buffer to the IC GDDRAM over DMA (SPIDMA::enabled only).
+  // Returns immediately; the SPI bus and DMA channel are idle again once the transfer completes.
+  // With a single sw buffer, don't draw until is_transfer_complete() or the completion callback.
+  // With triple buffering the newest presented frame becomes the front buffer first.
+  // @return true if the transfer started, false if DMA is disabled, the previous transfer is still running or the IC
+  // is scrolling
+  bool begin_frame_transfer()
+  {
+    if (spi_dma_setting != SPIDMA::enabled || !m_transfer_complete || m_state.scrolling)
     {
       return false;
     }
-    if (!send_command(static_cast<uint8_t>(hwcmd::default_mux_ratio)))
+    m_transfer_complete = false;
+    frame_begin();
+
+    if constexpr (FRAMEBUFFER_COUNT == 3)
     {
-      return false;
+      acquire_newest_frame();
     }
-    if (!send_command(static_cast<uint8_t>(hwcmd::set_vert_offset)))
+    start_dma_transfer();
+
+    // the whole buffer is on its way to the IC
+    clear_dirty();
+    return true;
+  }
+
+  // @brief Show the frame drawn to m_buffer.
+  // With double buffering and DMA the back and front buffers are swapped and the new front buffer is sent by a
+  // non-blocking transfer, so the application can draw the next frame while this one is sent. The new back buffer
+  // starts as a copy of the frame just presented.
+  // With triple buffering present() never waits for the bus: the frame is handed to the DMA ISR, which sends the
+  // newest presented frame when the running transfer completes. Frames presented faster than they can be sent
+  // are dropped.
+  // Without DMA this is the same as update_screen(). SPIDMA::interrupt and SPIDMA::paged stream from m_buffer while
+  // the application draws into it, so a double or triple buffered Driver runs them as SPIDMA::enabled instead.
+  // @return ErrorStatus DMA_BUSY if the previous frame is still being sent (single and double buffering only).
+  // Nothing is swapped; try again later. SCROLLING while the IC is scrolling, see start_scroll().
+  ErrorStatus present()
+  {
+    return measure_frame([this] { return present_frame(); });
+  }
+
+  // @brief Send a rectangle of the sw buffer to the IC GDDRAM (single sw buffer only).
+  // With DMA the horizontal addressing window is set to the rectangle and only its bytes are sent, by a
+  // non-blocking transfer: one DMA transfer if the rectangle is full width, otherwise one per page, chained by the
+  // DMA ISR. Don't draw inside the rectangle until is_transfer_complete() or the completion callback.
+  // Without DMA each page of the rectangle is sent in Page Addressing Mode, by the CPU or, with SPIDMA::interrupt,
+  // streamed by the SPI TXE interrupt. With SPIDMA::paged each page is one DMA transfer, chained by the DMA ISR.
+  // @param x0 The first column
+  // @param page0 The first page
+  // @param x1 The last column
+  // @param page1 The last page
+  // @return ErrorStatus PIXEL_OOB for an empty or out of bounds rectangle, DMA_BUSY if a transfer is running,
+  // SCROLLING while the IC is scrolling
+  ErrorStatus update_region(uint8_t x0, uint8_t page0, uint8_t x1, uint8_t page1)
+    requires(FRAMEBUFFER_COUNT == 1)
+  {
+    return measure_frame([this, x0, page0, x1, page1] { return send_region(x0, page0, x1, page1); });
+  }
+
+  // @brief Set the display contrast. Not sent if unchanged.
+  // @param contrast 1 of 256 contrast steps
+  // @return ErrorStatus DMA_BUSY if a frame transfer is running
+  ErrorStatus set_contrast(uint8_t contrast)
+  {
+    if (m_state.contrast == contrast)
     {
-      return false;
+      return ErrorStatus::OK;
     }
-    if (!send_command(static_cast<uint8_t>(hwcmd::vert_offset_none)))
+    const std::array<uint8_t, 2> cmd{static_cast<uint8_t>(fcmd::set_display_constrast), contrast};
+    ErrorStatus res = send_setting(cmd.data(), cmd.size());
+    if (res == ErrorStatus::OK)
     {
-      return false;
+      m_state.contrast = contrast;
     }
-    if (!send_command(static_cast<uint8_t>(hwcmd::set_com_pin_cfg)))
+    return res;
+  }
+
+  // @brief Set inverse display, 0 in RAM is ON in the display panel. Not sent if unchanged.
+  // @param inverse true for inverse, false for normal display
+  // @return ErrorStatus DMA_BUSY if a frame transfer is running
+  ErrorStatus set_inverse(bool inverse)
+  {
+    if (m_state.inverse == inverse)
     {
-      return false;
+      return ErrorStatus::OK;
     }
-    if (!send_command(static_cast<uint8_t>(hwcmd::com_pin_alt_remap_off)))
+    const uint8_t cmd = static_cast<uint8_t>(inverse ? fcmd::display_inverse_on : fcmd::display_inverse_off);
+    ErrorStatus res   = send_setting(&cmd, 1);
+    if (res == ErrorStatus::OK)
     {
-      return false;
+      m_state.inverse = inverse;
     }
+    return res;
+  }
 
-    // set timing/driving commands
-    if (!send_command(static_cast<uint8_t>(tcmd::clk_presc_freq)))
+  // @brief Switch the display on, or to sleep mode. Not sent if unchanged.
+  // @param on true for normal mode, false for sleep mode
+  // @return ErrorStatus DMA_BUSY if a frame transfer is running
+  ErrorStatus set_display_on(bool on)
+  {
+    if (m_state.display_on == on)
     {
-      return false;
+      return ErrorStatus::OK;
     }
-    if (!send_command(static_cast<uint8_t>(tcmd::clk_max_setting)))
+    const uint8_t cmd = static_cast<uint8_t>(on ? fcmd::display_mode_normal : fcmd::display_mode_sleep);
+    ErrorStatus res   = send_setting(&cmd, 1);
+    if (res == ErrorStatus::OK)
     {
-      return false;
+      m_state.display_on = on;
     }
-    if (!send_command(static_cast<uint8_t>(tcmd::set_precharge_period)))
+    return res;
+  }
+
+  // @brief Start scrolling a range of pages horizontally. Not sent if the same scroll is already active.
+  // GDDRAM must not be written while scrolling (section 10.1.1 of datasheet), so until stop_scroll() the updates
+  // return ErrorStatus::SCROLLING and the changes drawn meanwhile are kept for the first update after it.
+  // @param right true to scroll right, false to scroll left
+  // @param first_page The first page to scroll
+  // @param last_page The last page to scroll, not less than first_page
+  // @param interval The time between scroll steps, 0-7. Only the low 3 bits are used. See section 10.1.1 of datasheet.
+  // @return ErrorStatus PIXEL_OOB if the pages are not on the panel, DMA_BUSY if a frame transfer is running
+  ErrorStatus start_scroll(bool right, uint8_t first_page, uint8_t last_page, uint8_t interval)
+  {
+    if (first_page > last_page || last_page >= m_page_count)
     {
-      return false;
+      return ErrorStatus::PIXEL_OOB;
     }
-    if (!send_command(static_cast<uint8_t>(tcmd::default_precharge)))
+
+    const uint8_t direction     = static_cast<uint8_t>(right ? scmd::horiz_scroll_right : scmd::horiz_scroll_left);
+    const uint8_t step_interval = interval & 0x07;
+    if (m_state.scrolling && m_state.scroll_direction == direction && m_state.scroll_first_page == first_page &&
+        m_state.scroll_last_page == last_page && m_state.scroll_interval == step_interval)
     {
-      return false;
+      return ErrorStatus::OK;
     }
-    if (!send_command(static_cast<uint8_t>(tcmd::set_vcomh_lvl)))
+
+    // the scroll setup must not change while scrolling
+    const std::array<uint8_t, 9> cmd{
+        static_cast<uint8_t>(scmd::deactivate_scroll),
+        direction,
+        0x00,
+        first_page,
+        step_interval,
+        last_page,
+        0x00,
+        0xFF,
+        static_cast<uint8_t>(scmd::activate_scroll),
+    };
+    ErrorStatus res = send_setting(cmd.data(), cmd.size());
+    if (res == ErrorStatus::OK)
     {
-      return false;
+      m_state.scrolling         = true;
+      m_state.scroll_direction  = direction;
+      m_state.scroll_first_page = first_page;
+      m_state.scroll_last_page  = last_page;
+      m_state.scroll_interval   = step_interval;
     }
-    if (!send_command(static_cast<uint8_t>(tcmd::vcomh_vcc_077)))
+    return res;
+  }
+
+  // @brief Stop scrolling. Not sent if not scrolling. The GDDRAM must be rewritten afterwards.
+  // @return ErrorStatus DMA_BUSY if a frame transfer is running
+  ErrorStatus stop_scroll()
+  {
+    if (!m_state.scrolling)
     {
-      return false;
+      return ErrorStatus::OK;
     }
-
-    // wake up display
-    if (!send_command(static_cast<uint8_t>(fcmd::display_mode_normal)))
+    const uint8_t cmd = static_cast<uint8_t>(scmd::deactivate_scroll);
+    ErrorStatus res   = send_setting(&cmd, 1);
+    if (res == ErrorStatus::OK)
     {
-      return false;
+      m_state.scrolling = false;
+      this->mark_all_dirty();
     }
+    return res;
+  }
 
-    // Clear screen
-    fill(Colour::Black);
+  // @brief Get the bus to the IC, for instrumentation
+  // @return const TRANSPORT&
+  const TRANSPORT &transport() const { return m_transport; }
 
-    if (spi_dma_setting == SPIDMA::enabled)
-    {
-#if not defined(X86_UNIT_TESTING_ONLY)
-      // no more commands to send so set data mode/high signal
-      LL_GPIO_SetOutputPin(&m_serial_interface.get_dc_port(), m_serial_interface.get_dc_pin());
+  // @brief Get the last known IC register values
+  // @return const ControllerState&
+  const ControllerState &controller_state() const { return m_state; }
 
-      // setup the SPI DMA
-      stm32::spi_ref::enable_spi(m_serial_interface.get_spi_handle(), false);
+#if defined(SSD1306_BUS_STATISTICS)
+  // @brief Returns a timestamp for the frame transfer times, e.g. a cycle counter
+  using StatisticsClock = uint32_t (*)();
 
-      // cppcheck-suppress cstyleCast - CMSIS limitation
-      LL_DMA_SetDataLength(DMA1, LL_DMA_CHANNEL_1, (uint32_t)m_buffer.size());
-      // cppcheck-suppress cstyleCast - CMSIS limitation
-      LL_DMA_SetMemoryAddress(DMA1, LL_DMA_CHANNEL_1, (uint32_t)m_buffer.data());
-      // cppcheck-suppress cstyleCast - CMSIS limitation
-      LL_DMA_SetPeriphAddress(DMA1, LL_DMA_CHANNEL_1, (uint32_t)&SPI1->DR);
-      // cppcheck-suppress cstyleCast - CMSIS limitation
-      LL_DMA_EnableIT_TC(DMA1, LL_DMA_CHANNEL_1);
-      // cppcheck-suppress cstyleCast - CMSIS limitation
-      LL_DMA_EnableChannel(DMA1, LL_DMA_CHANNEL_1);
+  // @brief Set the clock used to time frame transfers. Without a clock the times are 0.
+  // @param clock The clock, or nullptr
+  void set_statistics_clock(StatisticsClock clock) { m_statistics_clock = clock; }
+
+  // @brief Get the bus cost of the last and all completed frames. A frame completes when update_screen(),
+  // present() or update_region() returns, or with DMA or SPIDMA::interrupt when the ISR finishes the transfer.
+  // @return const BusStatistics&
+  const BusStatistics &bus_statistics() const { return m_statistics; }
 
-      m_serial_interface.get_spi_handle().CR2 = m_serial_interface.get_spi_handle().CR2 | SPI_CR2_TXDMAEN;
-      stm32::spi_ref::enable_spi(m_serial_interface.get_spi_handle());
+  // @brief Clear the statistics
+  void reset_bus_statistics() { m_statistics = BusStatistics{}; }
 #endif
+
+  // @brief The cost of starting one more transfer, in bytes on the wire: the DC toggle and busy waits, the DMA
+  // reprogramming and the ISR. Used by plan_update() to weigh fewer, larger transfers against more, smaller ones.
+  static constexpr uint16_t m_transfer_overhead{8};
+
+  // @brief Choose the cheapest way to send the modified areas of the sw buffer, see UpdateStrategy.
+  // The cost of each strategy is its command and data bytes plus m_transfer_overhead per transfer.
+  // Without DMA, or when double or triple buffering, only one strategy applies.
+  // @return UpdatePlan the chosen plan
+  UpdatePlan plan_update()
+  {
+    // follow the address pointer through the page spans to count only the commands that will be sent
+    ControllerState state{m_state};
+    std::array<uint8_t, 3> preamble{};
+
+    UpdatePlan pages{UpdateStrategy::pages, 0xFF, 0xFF, 0, 0, 0, 0, 0};
+    for (uint8_t page_idx = 0; page_idx < m_page_count; page_idx++)
+    {
+      if (!is_dirty(page_idx))
+      {
+        continue;
+      }
+      const DirtySpan &span = dirty_span(page_idx);
+      pages.x0              = std::min(pages.x0, span.first);
+      pages.x1              = std::max(pages.x1, span.last);
+      pages.page0           = std::min(pages.page0, page_idx);
+      pages.page1           = page_idx;
+      if (spi_dma_setting != SPIDMA::enabled)
+      {
+        pages.command_bytes += page_preamble(state, page_idx, span.first, preamble);
+        advance_page_pointer(state, page_idx, span.last);
+      }
+      else
+      {
+        pages.command_bytes += is_window(state, span.first, page_idx, span.last, page_idx) ? 0 : 6;
+        set_window_state(state, span.first, page_idx, span.last, page_idx);
+      }
+      pages.data_bytes += span.last - span.first + 1;
+      pages.transfers++;
     }
 
-    // Flush buffer to screen
-    ErrorStatus res = update_screen();
-    if (res != ErrorStatus::OK)
+    if (pages.transfers == 0)
     {
-      return false;
+      return UpdatePlan{};
+    }
+    if (spi_dma_setting != SPIDMA::enabled)
+    {
+      return pages;
     }
 
-    // Set default values for screen object
-    m_currentx = 0;
-    m_currenty = 0;
+    UpdatePlan full_frame{UpdateStrategy::full_frame, 0, 0, m_page_width - 1, m_page_count - 1, 0, Common::m_buffer_size, 1};
+    full_frame.command_bytes = is_window(m_state, 0, 0, m_page_width - 1, m_page_count - 1) ? 0 : 6;
+    if constexpr (FRAMEBUFFER_COUNT > 1)
+    {
+      return full_frame;
+    }
 
-    return true;
+    UpdatePlan window{pages};
+    window.strategy      = UpdateStrategy::window;
+    window.command_bytes = is_window(m_state, window.x0, window.page0, window.x1, window.page1) ? 0 : 6;
+    window.data_bytes    = (window.x1 - window.x0 + 1) * (window.page1 - window.page0 + 1);
+    window.transfers     = (window.x0 == 0 && window.x1 == m_page_width - 1) ? 1 : window.page1 - window.page0 + 1;
+
+    // ties go to the non-blocking strategies, a window covering the whole frame is the full frame
+    const auto cost = [](const UpdatePlan &plan) { return plan.predicted_bytes() + plan.transfers * m_transfer_overhead; };
+    UpdatePlan cheapest{full_frame};
+    if (window.data_bytes < full_frame.data_bytes && cost(window) <= cost(cheapest))
+    {
+      cheapest = window;
+    }
+    if (cost(pages) < cost(cheapest))
+    {
+      cheapest = pages;
+    }
+    return cheapest;
   }
 
-  // @brief Convenience function to write msg to the display.
-  // @tparam FONT_SIZE The size of the font data, Uses template argument deduction.
-  // @param msg The message to display
-  // @param font The font size object: Font5x5, Font5x7, Font7x10, Font11x18, Font16x26
-  // @param x pos
-  // @param y pos
-  // @param bg The background colour
-  // @param fg The foreground colour
-  // @param padding add an extra pixel to the vertical edge of the character
-  // @param update write the sw buffer to the IC
-  // @return ErrorStatus
+  // @brief Get the plan used by the last update, for instrumentation
+  // @return const UpdatePlan&
+  const UpdatePlan &last_update_plan() const { return m_last_plan; }
 
-  template <std::size_t FONT_SIZE, std::size_t MSG_SIZE>
-  ErrorStatus write(
-      noarch::containers::StaticString<MSG_SIZE> &msg, Font<FONT_SIZE> &font, uint8_t x, uint8_t y, Colour bg, Colour fg, bool padding, bool update);
+  // @brief Check if the last frame transfer has finished
+  // @return true if no DMA or interrupt driven transfer is running
+  bool is_transfer_complete() const { return m_transfer_complete; }
+
+  // @brief Set the function called from the DMA or SPI ISR when a frame transfer completes.
+  // is_transfer_complete() is already true when it is called, so it can start the next transfer.
+  // With triple buffering it is not called for a frame that is followed straight away by a newer presented frame.
+  // @param callback The function to call, or nullptr to disable
+  // @param context Passed to the callback, e.g. the application object
+  void set_transfer_complete_callback(TransferCompleteCallback callback, void *context = nullptr)
+  {
+    m_transfer_complete_callback = callback;
+    m_transfer_complete_context  = context;
+  }
 
   // @brief callback function for InterruptManagerStm32g0
   // see stm32_interrupt_managers/inc/stm32g0_interrupt_manager_functional.hpp
@@ -287,7 +579,65 @@ public:
     LL_DMA_ClearFlag_HT1(DMA1);
     // cppcheck-suppress cstyleCast - CMSIS limitation
     LL_DMA_ClearFlag_TC1(DMA1);
+    // one-shot: the channel stays idle until the next begin_frame_transfer()
+    // cppcheck-suppress cstyleCast - CMSIS limitation
+    LL_DMA_DisableChannel(DMA1, LL_DMA_CHANNEL_1);
 #endif
+    // SPIDMA::paged: address the next page and send it
+    if (spi_dma_setting == SPIDMA::paged)
+    {
+      m_stream.page++;
+      if (load_stream_page())
+      {
+        start_paged_dma();
+        return;
+      }
+    }
+
+    // update_region(): the window is not full width, gather the next page
+    if (m_region.pages_left > 0)
+    {
+      start_dma(&m_buffer[m_region.next_page * m_page_width + m_region.first_col], m_region.width);
+      m_region.next_page++;
+      m_region.pages_left--;
+      return;
+    }
+
+    complete_transfer();
+  }
+
+  // @brief callback function for InterruptManagerStm32g0, SPIDMA::interrupt only.
+  // Each TXE interrupt queues the next command byte, or the next one or two data bytes, of m_stream.
+  // DC only changes once the bytes before it have been latched, so the ISR waits for BSY at each change,
+  // which is at most a TXFIFO of bytes.
+  void spi_isr()
+  {
+    if constexpr (TRANSPORT::spi_capable)
+    {
+      spi_stream_next();
+    }
+  }
+
+  // @brief Send a sequence of command bytes in one burst.
+  // With SPI, DC is set low once for the whole sequence and the bus is only checked for busy after the last byte,
+  // instead of once per byte. With I2C the sequence is one transaction.
+  // @tparam CMD_COUNT The number of command bytes
+  // @param cmd_bytes The command bytes, including any command arguments
+  // @return true if success, false if error
+  template <std::size_t CMD_COUNT>
+  bool send_commands(const std::array<uint8_t, CMD_COUNT> &cmd_bytes)
+  {
+    return send_commands(cmd_bytes.data(), CMD_COUNT);
+  }
+
+  // @brief Send a sequence of command bytes in one burst, see send_commands(const std::array&)
+  // @param cmd_bytes The command bytes, including any command arguments
+  // @param count The number of command bytes
+  // @return true if success, false if error
+  bool send_commands(const uint8_t *cmd_bytes, std::size_t count)
+  {
+    observe_commands(cmd_bytes, count);
+    return m_transport.send_commands(cmd_bytes, count);
   }
 
 #if defined(X86_UNIT_TESTING_ONLY) || defined(USE_RTT)
@@ -297,62 +647,256 @@ public:
 #endif
 
 private:
-  // object containing SPI port/pins and pointer to CMSIS defined SPI peripheral
-  DriverSerialInterface<DEVICE_ISR_ENUM> m_serial_interface;
-
-  // @brief SSD1306 Fundamental Commands - See Section 9 of datasheet for setting bytes
-  enum class fcmd
-  {
-    // @brief Double byte command to select 1 out of 256 contrast steps.
-    // Contrast increases as the value increases.
-    set_display_constrast = 0x81,
-    // @brief Maximum display contrast value
-    max_constrast = 0xFF,
-    // @brief Minimum display contrast value
-    min_constrast = 0x01,
-
-    // @brief Output follows RAM content
-    display_use_ram = 0xA4,
+  // @brief The bus to the IC
+  TRANSPORT m_transport;
 
-    // @brief Output ignores RAM content
-    display_ignore_ram = 0xA5,
-
-    // @brief Normal display - 0 in RAM: OFF in display panel, 1 in RAM: ON in display panel
-    display_inverse_off = 0xA6,
+  // @brief The framebuffer sent to the IC. The same as m_back_idx with a single sw buffer.
+  uint8_t m_front_idx{FRAMEBUFFER_COUNT - 1};
 
-    // @brief Inverse display - 1 in RAM: OFF in display panel, 0 in RAM: ON in display panel
-    display_inverse_on = 0xA7,
+  // @brief The framebuffer m_buffer refers to. Only changed by the render task.
+  uint8_t m_back_idx{0};
 
-    // @brief Driver off (sleep mode)
-    display_mode_sleep = 0xAE,
+  // @brief The plan used by the last update_screen()
+  UpdatePlan m_last_plan{};
 
-    // @brief Driver on in normal mode
-    display_mode_normal = 0xAF
+  // @brief The last known IC register values
+  ControllerState m_state{};
 
+  // @brief The rest of a running update_region() transfer, sent one page per DMA transfer
+  struct RegionTransfer
+  {
+    // @brief the first column of each page
+    uint8_t first_col{0};
+    // @brief the number of columns of each page
+    uint8_t width{0};
+    // @brief the next page to send
+    uint8_t next_page{0};
+    // @brief the number of pages still to send
+    uint8_t pages_left{0};
   };
+  RegionTransfer m_region{};
 
-  // @brief SSD1306 Scrolling Commands - See Section 9 of datasheet for setting bytes
-  enum class scmd
+  // @brief A running SPIDMA::interrupt transfer, advanced by spi_isr(), or SPIDMA::paged transfer, advanced by dma_isr()
+  struct StreamTransfer
   {
-    // @brief Right Horizontal Scroll
-    horiz_scroll_right = 0x26,
-    // @brief Left Horizontal Scroll
-    horiz_scroll_left = 0x27,
-    // @brief Vertical and right Horizontal Scroll
-    both_scroll_right = 0x29,
-    // @brief Vertical and left Horizontal Scroll
-    both_scroll_left = 0x2A,
-    // @brief Start scrolling
-    activate_scroll = 0x2F,
-    // @brief Stop scrolling
-    deactivate_scroll = 0x2E,
-    // @brief Set Vertical scrolling area
-    vert_scroll_area = 0xA3
+    enum class Phase : uint8_t
+    {
+      commands,
+      data
+    };
+    // @brief the column range to send from each page, clean pages are skipped
+    std::array<DirtySpan, m_page_count> spans{};
+    // @brief the page being sent
+    uint8_t page{0};
+    // @brief sending the page and column commands, or the data, of the page
+    Phase phase{Phase::commands};
+    // @brief the page and column commands of the page, see page_preamble()
+    std::array<uint8_t, 3> commands{};
+    uint8_t command_count{0};
+    // @brief the next command to send
+    uint8_t command_idx{0};
+    // @brief the next byte to send, and the end of the page data in the sw buffer
+    uint16_t data_pos{0};
+    uint16_t data_end{0};
   };
+  StreamTransfer m_stream{};
 
-  // @brief SSD1306 Address Commands
-  enum class acmd
-  {
+  // @brief Set in m_ready when it holds a presented frame that has not been sent yet
+  static constexpr uint8_t m_fresh_frame{0x80};
+
+  // @brief Triple buffering: the framebuffer between the back and front buffers, with m_fresh_frame.
+  // This is the only state shared by the render task and the DMA ISR. It is only ever exchanged, see exchange_ready(),
+  // so each side always owns its own buffer.
+  std::atomic<uint8_t> m_ready{1};
+
+  // @brief Cleared when a DMA or interrupt driven transfer starts, set by dma_isr() or spi_isr()
+  std::atomic<bool> m_transfer_complete{true};
+
+  // the ISR state is only loaded and stored, which Cortex-M0+ does without libatomic
+  static_assert(std::atomic<uint8_t>::is_always_lock_free && std::atomic<bool>::is_always_lock_free,
+                "The state shared with the ISRs needs lock-free atomic loads and stores");
+
+  // @brief Called by dma_isr() when a frame transfer completes
+  TransferCompleteCallback m_transfer_complete_callback{nullptr};
+
+  // @brief Passed to m_transfer_complete_callback
+  void *m_transfer_complete_context{nullptr};
+
+#if defined(SSD1306_BUS_STATISTICS)
+  // @brief Bus traffic since the last completed frame
+  BusCounters m_counters{};
+
+  // @brief The completed frames
+  BusStatistics m_statistics{};
+
+  // @brief Times the frames, optional
+  StatisticsClock m_statistics_clock{nullptr};
+
+  // @brief The time the running frame started
+  uint32_t m_frame_start{0};
+
+  // @brief A frame has started and not completed
+  bool m_frame_open{false};
+
+  // @brief The bus was last in data mode, for counting DC toggles
+  bool m_dc_data{false};
+#endif
+
+  // @brief Count a burst of command bytes, if SSD1306_BUS_STATISTICS is defined, and pass it to a RecordingTransport
+  // @param cmd_bytes The bytes
+  // @param count The number of bytes
+  void observe_commands([[maybe_unused]] const uint8_t *cmd_bytes, [[maybe_unused]] std::size_t count)
+  {
+    if constexpr (requires(TRANSPORT &bus) { bus.record_commands(cmd_bytes, count); })
+    {
+      m_transport.record_commands(cmd_bytes, count);
+    }
+#if defined(SSD1306_BUS_STATISTICS)
+    m_counters.command_bytes += count;
+    m_counters.transfers++;
+    if (m_dc_data)
+    {
+      m_counters.dc_toggles++;
+      m_dc_data = false;
+    }
+#endif
+  }
+
+  // @brief Count a burst or DMA transfer of data bytes, if SSD1306_BUS_STATISTICS is defined, and pass it to a
+  // RecordingTransport
+  // @param data_bytes The bytes
+  // @param length The number of bytes
+  void observe_data([[maybe_unused]] const uint8_t *data_bytes, [[maybe_unused]] std::size_t length)
+  {
+    if constexpr (requires(TRANSPORT &bus) { bus.record_data(data_bytes, length); })
+    {
+      m_transport.record_data(data_bytes, length);
+    }
+#if defined(SSD1306_BUS_STATISTICS)
+    m_counters.data_bytes += length;
+    m_counters.transfers++;
+    if (!m_dc_data)
+    {
+      m_counters.dc_toggles++;
+      m_dc_data = true;
+    }
+#endif
+  }
+
+  // @brief Start timing a frame, unless one is running
+  void frame_begin()
+  {
+#if defined(SSD1306_BUS_STATISTICS)
+    if (!m_frame_open)
+    {
+      m_frame_open  = true;
+      m_frame_start = (m_statistics_clock != nullptr) ? m_statistics_clock() : 0;
+    }
+#endif
+  }
+
+  // @brief Complete the running frame and add its cost to the statistics
+  void frame_end()
+  {
+    if constexpr (requires(TRANSPORT &bus) { bus.record_frame(); })
+    {
+      m_transport.record_frame();
+    }
+#if defined(SSD1306_BUS_STATISTICS)
+    if (!m_frame_open)
+    {
+      return;
+    }
+    m_frame_open = false;
+
+    // an update with nothing to send is not a frame
+    if (m_counters.transfers == 0)
+    {
+      return;
+    }
+    const uint32_t ticks = (m_statistics_clock != nullptr) ? m_statistics_clock() - m_frame_start : 0;
+
+    m_statistics.frame = m_counters;
+    m_statistics.total += m_counters;
+    m_statistics.frames++;
+    m_statistics.last_frame_ticks = ticks;
+    m_statistics.min_frame_ticks  = std::min(m_statistics.min_frame_ticks, ticks);
+    m_statistics.max_frame_ticks  = std::max(m_statistics.max_frame_ticks, ticks);
+    m_counters                    = BusCounters{};
+#endif
+  }
+
+  // @brief Run an update as one frame of the statistics
+  // @tparam UPDATE The update function, returning ErrorStatus
+  // @param update The update
+  // @return ErrorStatus the result of the update
+  template <typename UPDATE>
+  ErrorStatus measure_frame(UPDATE update)
+  {
+    frame_begin();
+    ErrorStatus res = update();
+
+    // blocking transfers are done, DMA and interrupt driven transfers complete in the ISR
+    if (m_transfer_complete)
+    {
+      frame_end();
+    }
+    return res;
+  }
+
+  // @brief SSD1306 Fundamental Commands - See Section 9 of datasheet for setting bytes
+  enum class fcmd
+  {
+    // @brief Double byte command to select 1 out of 256 contrast steps.
+    // Contrast increases as the value increases.
+    set_display_constrast = 0x81,
+    // @brief Maximum display contrast value
+    max_constrast = 0xFF,
+    // @brief Minimum display contrast value
+    min_constrast = 0x01,
+
+    // @brief Output follows RAM content
+    display_use_ram = 0xA4,
+
+    // @brief Output ignores RAM content
+    display_ignore_ram = 0xA5,
+
+    // @brief Normal display - 0 in RAM: OFF in display panel, 1 in RAM: ON in display panel
+    display_inverse_off = 0xA6,
+
+    // @brief Inverse display - 1 in RAM: OFF in display panel, 0 in RAM: ON in display panel
+    display_inverse_on = 0xA7,
+
+    // @brief Driver off (sleep mode)
+    display_mode_sleep = 0xAE,
+
+    // @brief Driver on in normal mode
+    display_mode_normal = 0xAF
+
+  };
+
+  // @brief SSD1306 Scrolling Commands - See Section 9 of datasheet for setting bytes
+  enum class scmd
+  {
+    // @brief Right Horizontal Scroll
+    horiz_scroll_right = 0x26,
+    // @brief Left Horizontal Scroll
+    horiz_scroll_left = 0x27,
+    // @brief Vertical and right Horizontal Scroll
+    both_scroll_right = 0x29,
+    // @brief Vertical and left Horizontal Scroll
+    both_scroll_left = 0x2A,
+    // @brief Start scrolling
+    activate_scroll = 0x2F,
+    // @brief Stop scrolling
+    deactivate_scroll = 0x2E,
+    // @brief Set Vertical scrolling area
+    vert_scroll_area = 0xA3
+  };
+
+  // @brief SSD1306 Address Commands
+  enum class acmd
+  {
 
     set_memory_mode = 0x20, // @brief Set the addressing mode - use one of the below modes
     horiz_addr_mode = 0x00, // @brief Horizontal Addressing Mode
@@ -444,6 +988,54 @@ private:
 
   };
 
+public:
+  // @brief The setup commands sent by power_on_sequence(), built at compile time for the panel.
+  // Sent as one burst while the display sleeps.
+  static constexpr std::array<uint8_t, 20> m_init_commands{
+      static_cast<uint8_t>(fcmd::display_mode_sleep),
+      static_cast<uint8_t>(fcmd::display_use_ram),
+      static_cast<uint8_t>(fcmd::display_inverse_off),
+      static_cast<uint8_t>(fcmd::set_display_constrast),
+      static_cast<uint8_t>(fcmd::max_constrast),
+      static_cast<uint8_t>(hwcmd::start_line_0),
+      static_cast<uint8_t>(hwcmd::vert_flip_normal),
+      static_cast<uint8_t>(hwcmd::horiz_flip_normal),
+      static_cast<uint8_t>(hwcmd::set_mux_ratio),
+      GEOMETRY::mux_ratio,
+      static_cast<uint8_t>(hwcmd::set_vert_offset),
+      static_cast<uint8_t>(hwcmd::vert_offset_none),
+      static_cast<uint8_t>(hwcmd::set_com_pin_cfg),
+      GEOMETRY::com_pin_cfg,
+      static_cast<uint8_t>(tcmd::clk_presc_freq),
+      static_cast<uint8_t>(tcmd::clk_max_setting),
+      static_cast<uint8_t>(tcmd::set_precharge_period),
+      static_cast<uint8_t>(tcmd::default_precharge),
+      static_cast<uint8_t>(tcmd::set_vcomh_lvl),
+      static_cast<uint8_t>(tcmd::vcomh_vcc_077),
+  };
+
+  // @brief Horizontal addressing mode over the whole panel, used with DMA
+  static constexpr std::array<uint8_t, 8> m_horiz_addr_commands{
+      static_cast<uint8_t>(acmd::set_memory_mode),
+      static_cast<uint8_t>(acmd::horiz_addr_mode),
+      static_cast<uint8_t>(acmd::set_column_address),
+      GEOMETRY::column_offset,
+      static_cast<uint8_t>(GEOMETRY::column_offset + GEOMETRY::width - 1),
+      static_cast<uint8_t>(acmd::set_page_address),
+      0x00,
+      static_cast<uint8_t>(Common::m_page_count - 1),
+  };
+
+  // @brief Page addressing mode starting at the first panel column of page 0, used without DMA
+  static constexpr std::array<uint8_t, 5> m_page_addr_commands{
+      static_cast<uint8_t>(acmd::set_memory_mode),
+      static_cast<uint8_t>(acmd::page_addr_mode),
+      static_cast<uint8_t>(acmd::start_page_0),
+      static_cast<uint8_t>(static_cast<uint8_t>(acmd::start_lcol_0) | (GEOMETRY::column_offset & 0x0F)),
+      static_cast<uint8_t>(static_cast<uint8_t>(acmd::start_hcol_0) | (GEOMETRY::column_offset >> 4)),
+  };
+
+private:
   // @brief callback handler for DMA interrupts
   struct DmaIntHandler : public stm32::isr::InterruptManagerStm32Base<DEVICE_ISR_ENUM>
   {
@@ -454,7 +1046,14 @@ private:
     DmaIntHandler(Driver *parent_driver_ptr)
         : m_parent_driver_ptr(*parent_driver_ptr)
     {
-      stm32::isr::InterruptManagerStm32Base<DEVICE_ISR_ENUM>::register_handler(m_parent_driver_ptr.m_serial_interface.get_dma_isr_type(), this);
+      // SPIDMA::interrupt is for boards where the DMA channel belongs to someone else
+      if constexpr (TRANSPORT::spi_capable)
+      {
+        if (m_parent_driver_ptr.spi_dma_setting != SPIDMA::interrupt)
+        {
+          stm32::isr::InterruptManagerStm32Base<DEVICE_ISR_ENUM>::register_handler(m_parent_driver_ptr.m_transport.serial_interface().get_dma_isr_type(), this);
+        }
+      }
     }
     // @brief Definition of InterruptManagerStm32Base::ISR. This is called by stm32::isr::InterruptManagerStm32Base<DEVICE_ISR_ENUM> specialization
     virtual void ISR() { m_parent_driver_ptr.dma_isr(); }
@@ -462,116 +1061,620 @@ private:
   // @brief handler object
   DmaIntHandler m_dma_int_handler{this};
 
-  // @brief Reset the Driver IC and SW buffer.
-  void reset()
+  // @brief callback handler for SPI interrupts, SPIDMA::interrupt only
+  struct SpiIntHandler : public stm32::isr::InterruptManagerStm32Base<DEVICE_ISR_ENUM>
   {
-#if not defined(X86_UNIT_TESTING_ONLY)
-    // Signal the driver IC to reset the OLED display
-    LL_GPIO_ResetOutputPin(&m_serial_interface.get_reset_port(), m_serial_interface.get_reset_pin());
-    stm32::delay_millisecond(10);
-    LL_GPIO_SetOutputPin(&m_serial_interface.get_reset_port(), m_serial_interface.get_reset_pin());
-    stm32::delay_millisecond(10);
-#endif
-    // reset the sw buffer
-    m_buffer.fill(0);
+    // @brief the parent driver class
+    Driver &m_parent_driver_ptr;
+    // @brief initialise and register this handler instance with InterruptManagerStm32g0
+    // @param parent_driver_ptr the instance to register
+    SpiIntHandler(Driver *parent_driver_ptr)
+        : m_parent_driver_ptr(*parent_driver_ptr)
+    {
+      if constexpr (TRANSPORT::spi_capable)
+      {
+        if (m_parent_driver_ptr.spi_dma_setting == SPIDMA::interrupt)
+        {
+          stm32::isr::InterruptManagerStm32Base<DEVICE_ISR_ENUM>::register_handler(m_parent_driver_ptr.m_transport.serial_interface().get_spi_isr_type(), this);
+        }
+      }
+    }
+    // @brief Definition of InterruptManagerStm32Base::ISR. This is called by stm32::isr::InterruptManagerStm32Base<DEVICE_ISR_ENUM> specialization
+    virtual void ISR() { m_parent_driver_ptr.spi_isr(); }
+  };
+  // @brief handler object
+  SpiIntHandler m_spi_int_handler{this};
+
+  // @brief Send the commands of a setting, unless a frame transfer is using the bus
+  // @param cmd_bytes The command bytes
+  // @param count The number of command bytes
+  // @return ErrorStatus
+  ErrorStatus send_setting(const uint8_t *cmd_bytes, std::size_t count)
+  {
+    if (!m_transfer_complete)
+    {
+      return ErrorStatus::DMA_BUSY;
+    }
+    return send_commands(cmd_bytes, count) ? ErrorStatus::OK : ErrorStatus::SEND_CMD_ERR;
   }
 
-  // @brief Write the sw buffer to the IC GDDRAM (Page Addressing Mode only)
-  ErrorStatus update_screen()
+  // @brief Triple buffering: make the fresh frame the front buffer, leaving the old front buffer to be recycled.
+  // Only called from the DMA ISR or while no transfer is running.
+  void acquire_newest_frame()
   {
-    // DMA doesn't require explicitly send of commands or data
-    if (spi_dma_setting == SPIDMA::disabled)
+    if (m_ready.load() & m_fresh_frame)
+    {
+      m_front_idx = exchange_ready(m_front_idx) & ~m_fresh_frame;
+    }
+  }
+
+  // @brief Swap the framebuffer in m_ready, in a CriticalSection instead of an atomic exchange, which Cortex-M0+ lacks
+  // @param value The new framebuffer index and flags
+  // @return uint8_t the previous framebuffer index and flags
+  uint8_t exchange_ready(uint8_t value)
+  {
+    CriticalSection critical_section;
+    const uint8_t previous = m_ready.load(std::memory_order_relaxed);
+    m_ready.store(value, std::memory_order_relaxed);
+    return previous;
+  }
+
+  // @brief End the frame that has just been sent. With triple buffering, go straight on to the newest frame presented
+  // during the transfer. Otherwise the bus is idle before the completion callback runs, so the callback can start the
+  // next transfer.
+  void complete_transfer()
+  {
+    frame_end();
+    trace::record(trace::TracePoint::transfer_complete, trace::TracePhase::instant);
+
+    if constexpr (FRAMEBUFFER_COUNT == 3)
     {
-      for (uint8_t page_idx = 0; page_idx < 8; page_idx++)
+      if (m_ready.load() & m_fresh_frame)
       {
+        frame_begin();
+        acquire_newest_frame();
+        start_dma_transfer();
+        return;
+      }
+    }
+    m_transfer_complete = true;
+    if (m_transfer_complete_callback != nullptr)
+    {
+      m_transfer_complete_callback(m_transfer_complete_context);
+    }
+  }
 
-        // Set Page position to write to: 0-7
-        if (!send_command(static_cast<uint8_t>(acmd::start_page_0) + page_idx))
-        {
-          return ErrorStatus::START_PAGE_ERR;
-        }
+  // @brief spi_isr(): queue the next bytes of m_stream
+  void spi_stream_next()
+  {
+    DriverSerialInterface<DEVICE_ISR_ENUM> &serial_interface = m_transport.serial_interface();
+    SPI_TypeDef &spi_handle                                  = serial_interface.get_spi_handle();
 
-        // Set the lower start column address of pointer by command 00h~0Fh.
-        if (!send_command(static_cast<uint8_t>(acmd::start_lcol_0)))
+    if (m_stream.phase == StreamTransfer::Phase::commands)
+    {
+      if (m_stream.command_idx < m_stream.command_count)
+      {
+        if (m_stream.command_idx == 0)
         {
-          return ErrorStatus::START_LCOL_ERR;
+          m_transport.wait_for_bsy();
+#if not defined(X86_UNIT_TESTING_ONLY)
+          LL_GPIO_ResetOutputPin(&serial_interface.get_dc_port(), serial_interface.get_dc_pin());
+#endif
         }
+        stm32::spi_ref::send_byte(spi_handle, m_stream.commands[m_stream.command_idx++]);
+        return;
+      }
 
-        // Set the upper start column address of pointer by command 10h~1Fh
-        if (!send_command(static_cast<uint8_t>(acmd::start_hcol_0)))
-        {
-          return ErrorStatus::START_HCOL_ERR;
-        }
+      m_transport.wait_for_bsy();
+#if not defined(X86_UNIT_TESTING_ONLY)
+      LL_GPIO_SetOutputPin(&serial_interface.get_dc_port(), serial_interface.get_dc_pin());
+#endif
+      m_stream.phase = StreamTransfer::Phase::data;
+    }
 
-        // the next page position within the GDDRAM buffer
-        uint16_t page_pos_gddram{static_cast<uint16_t>(m_page_width * page_idx)};
+    const uint16_t remaining = m_stream.data_end - m_stream.data_pos;
+    if (remaining >= 2)
+    {
+      TRANSPORT::send_packed_bytes(spi_handle, m_buffer[m_stream.data_pos], m_buffer[m_stream.data_pos + 1]);
+      m_stream.data_pos += 2;
+      return;
+    }
+    if (remaining == 1)
+    {
+      stm32::spi_ref::send_byte(spi_handle, m_buffer[m_stream.data_pos++]);
+      return;
+    }
 
-        if (!send_page_data(page_pos_gddram))
-        {
-          return ErrorStatus::SEND_DATA_ERR;
-        }
+    // this page is queued, TXE stays set so the next interrupt starts the next page
+    m_stream.page++;
+    if (load_stream_page())
+    {
+      return;
+    }
+
+    spi_handle.CR2 = spi_handle.CR2 & ~SPI_CR2_TXEIE;
+    m_transport.wait_for_bsy();
+    complete_transfer();
+  }
+
+  // @brief Start streaming m_stream.spans from the SPI TXE interrupt, or with SPIDMA::paged the DMA ISR
+  void start_stream()
+  {
+    m_stream.page = 0;
+    if (!load_stream_page())
+    {
+      return;
+    }
+    m_transfer_complete = false;
+
+    if (spi_dma_setting == SPIDMA::paged)
+    {
+      start_paged_dma();
+      return;
+    }
+
+    // TXE is already set, so the first interrupt fires straight away
+    if constexpr (TRANSPORT::spi_capable)
+    {
+      SPI_TypeDef &spi_handle = m_transport.serial_interface().get_spi_handle();
+      spi_handle.CR2          = spi_handle.CR2 | SPI_CR2_TXEIE;
+    }
+  }
+
+  // @brief Prepare m_stream to send the next page with a span, starting at m_stream.page
+  // @return false if there are no more pages
+  bool load_stream_page()
+  {
+    while (m_stream.page < m_page_count && m_stream.spans[m_stream.page].first > m_stream.spans[m_stream.page].last)
+    {
+      m_stream.page++;
+    }
+    if (m_stream.page == m_page_count)
+    {
+      return false;
+    }
+
+    const DirtySpan &span  = m_stream.spans[m_stream.page];
+    m_stream.phase         = StreamTransfer::Phase::commands;
+    m_stream.command_count = page_preamble(m_state, m_stream.page, span.first, m_stream.commands);
+    m_stream.command_idx   = 0;
+    m_stream.data_pos      = m_stream.page * m_page_width + span.first;
+    m_stream.data_end      = m_stream.page * m_page_width + span.last + 1;
+    advance_page_pointer(m_state, m_stream.page, span.last);
+
+    // SPIDMA::paged counts its bursts and transfers as they are sent
+    if (spi_dma_setting == SPIDMA::interrupt)
+    {
+      if (m_stream.command_count > 0)
+      {
+        observe_commands(m_stream.commands.data(), m_stream.command_count);
       }
+      observe_data(&m_buffer[m_stream.data_pos], m_stream.data_end - m_stream.data_pos);
+    }
+    return true;
+  }
 
-      // dump_buffer(true);
+  // @brief SPIDMA::paged: send the page and column commands of the m_stream page, then start the DMA transfer of its data.
+  // The commands are only a few bytes, so the DMA ISR sends them itself.
+  void start_paged_dma()
+  {
+    if (m_stream.command_count > 0)
+    {
+      send_commands(m_stream.commands.data(), m_stream.command_count);
     }
+    start_dma(&m_buffer[m_stream.data_pos], m_stream.data_end - m_stream.data_pos);
+  }
 
-    return ErrorStatus::OK;
+  // @brief Send the whole front buffer. Restores the full panel window after update_region().
+  void start_dma_transfer()
+  {
+    send_window(0, 0, m_page_width - 1, m_page_count - 1);
+    start_dma(m_framebuffers[m_front_idx].data(), m_framebuffers[m_front_idx].size());
   }
 
-  // @brief Send one command over SPI
-  // @param cmd_byte The byte to send
-  // @return true if success, false if error
-  bool send_command(uint8_t cmd_byte [[maybe_unused]])
+  // @brief Point the DMA channel at a block of memory and start it
+  // @param data The first byte to send
+  // @param length The number of bytes to send
+  void start_dma(const uint8_t *data [[maybe_unused]], uint16_t length [[maybe_unused]])
   {
+    observe_data(data, length);
+    if constexpr (TRANSPORT::spi_capable)
+    {
+      DriverSerialInterface<DEVICE_ISR_ENUM> &serial_interface [[maybe_unused]] = m_transport.serial_interface();
+
+      // the last command byte must be latched before switching to data mode
+      m_transport.wait_for_bsy();
+
 #if not defined(X86_UNIT_TESTING_ONLY)
-    // set cmd mode/low signal after we put data into TXFIFO to avoid premature latching
-    LL_GPIO_ResetOutputPin(&m_serial_interface.get_dc_port(), m_serial_interface.get_dc_pin());
+      // set data mode/high signal
+      LL_GPIO_SetOutputPin(&serial_interface.get_dc_port(), serial_interface.get_dc_pin());
 
-    // send the command over SPI bus
-    stm32::spi_ref::send_byte(m_serial_interface.get_spi_handle(), cmd_byte);
+      // cppcheck-suppress cstyleCast - CMSIS limitation
+      LL_DMA_DisableChannel(DMA1, LL_DMA_CHANNEL_1);
+      // cppcheck-suppress cstyleCast - CMSIS limitation
+      LL_DMA_SetDataLength(DMA1, LL_DMA_CHANNEL_1, (uint32_t)length);
+      // cppcheck-suppress cstyleCast - CMSIS limitation
+      LL_DMA_SetMemoryAddress(DMA1, LL_DMA_CHANNEL_1, (uint32_t)data);
+      // cppcheck-suppress cstyleCast - CMSIS limitation
+      LL_DMA_EnableChannel(DMA1, LL_DMA_CHANNEL_1);
 #endif
-    return true;
+    }
   }
 
-  // @brief send one page of the display buffer over SPI
-  // @param page_pos_gddram The index position of the page within the buffer
-  // @return true if success, false if error
-  bool send_page_data(uint16_t page_pos_gddram [[maybe_unused]])
+  // @brief Reset the Driver IC and SW buffer.
+  void reset()
+  {
+    // Signal the driver IC to reset the OLED display
+    m_transport.hardware_reset();
+    // reset the sw buffers
+    for (auto &framebuffer : m_framebuffers)
+    {
+      framebuffer.fill(0);
+    }
+
+    // the IC registers are back at their reset values
+    m_state = ControllerState{};
+  }
+
+  // @brief Write the modified areas of the sw buffer to the IC GDDRAM, using the cheapest plan, see plan_update().
+  ErrorStatus update_screen()
   {
+    trace::TraceScope scope{trace::TracePoint::update_screen};
+    return measure_frame([this] { return send_update(); });
+  }
 
-    // transmit bytes from this page (page_pos_gddram -> page_pos_gddram + m_page_width)
-    for (uint16_t idx = page_pos_gddram; idx < page_pos_gddram + m_page_width; idx++)
+  // @brief update_screen() without the frame statistics
+  ErrorStatus send_update()
+  {
+    m_last_plan = plan_update();
+    if (m_last_plan.strategy != UpdateStrategy::none && m_state.scrolling)
     {
-      if (!stm32::spi_ref::wait_for_txe_flag(m_serial_interface.get_spi_handle()))
+      return ErrorStatus::SCROLLING;
+    }
+    switch (m_last_plan.strategy)
+    {
+      case UpdateStrategy::none:
+        return ErrorStatus::OK;
+      case UpdateStrategy::full_frame:
+        return present_frame();
+      case UpdateStrategy::window:
+        if constexpr (FRAMEBUFFER_COUNT == 1)
+        {
+          return send_region(m_last_plan.x0, m_last_plan.page0, m_last_plan.x1, m_last_plan.page1);
+        }
+        break;
+      case UpdateStrategy::pages:
+        break;
+    }
+
+    // the CPU or the SPI TXE interrupt sends each modified page span, after any running transfer
+    if (!m_transfer_complete)
+    {
+      return ErrorStatus::DMA_BUSY;
+    }
+    if (spi_dma_setting == SPIDMA::interrupt || spi_dma_setting == SPIDMA::paged)
+    {
+      for (uint8_t page_idx = 0; page_idx < m_page_count; page_idx++)
       {
-#if defined(USE_RTT)
-        SEGGER_RTT_printf(0, "\nsend_page_data(): Tx buffer is full.");
-#endif
+        m_stream.spans[page_idx] = dirty_span(page_idx);
+      }
+      start_stream();
+      clear_dirty();
+      return ErrorStatus::OK;
+    }
+    for (uint8_t page_idx = 0; page_idx < m_page_count; page_idx++)
+    {
+      // nothing changed on this page since the last update
+      if (!is_dirty(page_idx))
+      {
+        continue;
       }
-      if (!stm32::spi_ref::wait_for_bsy_flag(m_serial_interface.get_spi_handle()))
+      const DirtySpan &span = dirty_span(page_idx);
+      ErrorStatus res = (spi_dma_setting == SPIDMA::enabled) ? send_window_span(page_idx, span.first, span.last)
+                                                             : send_page_span(page_idx, span.first, span.last);
+      if (res != ErrorStatus::OK)
       {
-#if defined(USE_RTT)
-        SEGGER_RTT_printf(0, "\nsend_page_data(): SPI bus is busy.");
-#endif
+        return res;
       }
-      // send the page over SPI bus
-      stm32::spi_ref::send_byte(m_serial_interface.get_spi_handle(), m_buffer[idx]);
+    }
 
-// set data mode/high signal after we put data into TXFIFO to avoid premature latching
-#ifndef X86_UNIT_TESTING_ONLY
-      LL_GPIO_SetOutputPin(&m_serial_interface.get_dc_port(), m_serial_interface.get_dc_pin());
-#endif
+    // the IC GDDRAM now matches the sw buffer
+    clear_dirty();
+
+    return ErrorStatus::OK;
+  }
+
+  // @brief The transfer mode to run in, see the constructor
+  // @param dma_option The requested mode
+  // @return SPIDMA
+  static constexpr SPIDMA supported_mode(SPIDMA dma_option)
+  {
+    if (!TRANSPORT::spi_capable)
+    {
+      return SPIDMA::disabled;
     }
+    // only full frame DMA sends a buffer the application is not drawing into
+    if (FRAMEBUFFER_COUNT > 1 && (dma_option == SPIDMA::interrupt || dma_option == SPIDMA::paged))
+    {
+      return SPIDMA::enabled;
+    }
+    return dma_option;
+  }
+
+  // @brief present() without the frame statistics
+  ErrorStatus present_frame()
+  {
+    if (m_state.scrolling)
+    {
+      return ErrorStatus::SCROLLING;
+    }
+    if (spi_dma_setting != SPIDMA::enabled)
+    {
+      return send_update();
+    }
+
+    if constexpr (FRAMEBUFFER_COUNT == 3)
+    {
+      // publish the back buffer as the newest frame. An unsent older frame is taken back and drawn over.
+      const uint8_t presented_idx = m_back_idx;
+      m_back_idx                  = exchange_ready(presented_idx | m_fresh_frame) & ~m_fresh_frame;
+      m_framebuffers[m_back_idx]  = m_framebuffers[presented_idx];
+      m_buffer                    = m_framebuffers[m_back_idx];
+      clear_dirty();
+
+      // if a transfer is running the DMA ISR sends the frame when it completes, otherwise start it now
+      begin_frame_transfer();
+      return ErrorStatus::OK;
+    }
+
+    if (!m_transfer_complete)
+    {
+      return ErrorStatus::DMA_BUSY;
+    }
+
+    if constexpr (FRAMEBUFFER_COUNT == 2)
+    {
+      std::swap(m_front_idx, m_back_idx);
+      m_framebuffers[m_back_idx] = m_framebuffers[m_front_idx];
+      m_buffer                   = m_framebuffers[m_back_idx];
+    }
+
+    begin_frame_transfer();
+    return ErrorStatus::OK;
+  }
+
+  // @brief update_region() without the frame statistics
+  // Only with a single sw buffer: with more, use present() to swap buffers.
+  ErrorStatus send_region(uint8_t x0, uint8_t page0, uint8_t x1, uint8_t page1)
+    requires(FRAMEBUFFER_COUNT == 1)
+  {
+    if (x0 > x1 || page0 > page1 || x1 >= m_page_width || page1 >= m_page_count)
+    {
+      return ErrorStatus::PIXEL_OOB;
+    }
+    if (m_state.scrolling)
+    {
+      return ErrorStatus::SCROLLING;
+    }
+
+    if (spi_dma_setting == SPIDMA::disabled)
+    {
+      for (uint8_t page_idx = page0; page_idx <= page1; page_idx++)
+      {
+        ErrorStatus res = send_page_span(page_idx, x0, x1);
+        if (res != ErrorStatus::OK)
+        {
+          return res;
+        }
+      }
+    }
+    else if (spi_dma_setting == SPIDMA::interrupt || spi_dma_setting == SPIDMA::paged)
+    {
+      if (!m_transfer_complete)
+      {
+        return ErrorStatus::DMA_BUSY;
+      }
+      m_stream.spans.fill(DirtySpan{});
+      for (uint8_t page_idx = page0; page_idx <= page1; page_idx++)
+      {
+        m_stream.spans[page_idx] = DirtySpan{x0, x1};
+      }
+      start_stream();
+    }
+    else
+    {
+      if (!m_transfer_complete)
+      {
+        return ErrorStatus::DMA_BUSY;
+      }
+      m_transfer_complete = false;
+
+      if (!send_window(x0, page0, x1, page1))
+      {
+        m_transfer_complete = true;
+        return ErrorStatus::START_PAGE_ERR;
+      }
+
+      if (x0 == 0 && x1 == m_page_width - 1)
+      {
+        // full width pages are contiguous in the sw buffer
+        start_dma(&m_buffer[page0 * m_page_width], (page1 - page0 + 1) * m_page_width);
+      }
+      else
+      {
+        m_region = RegionTransfer{x0, static_cast<uint8_t>(x1 - x0 + 1), static_cast<uint8_t>(page0 + 1), static_cast<uint8_t>(page1 - page0)};
+        start_dma(&m_buffer[page0 * m_page_width + x0], m_region.width);
+      }
+    }
+
+    // the rectangle is up to date, unless a page was also modified outside it
+    for (uint8_t page_idx = page0; page_idx <= page1; page_idx++)
+    {
+      if (dirty_span(page_idx).first >= x0 && dirty_span(page_idx).last <= x1)
+      {
+        this->m_dirty_spans[page_idx] = DirtySpan{};
+      }
+    }
+    return ErrorStatus::OK;
+  }
+
+  // @brief Set the Horizontal Addressing Mode window
+  // @param x0 The first column
+  // @param page0 The first page
+  // @param x1 The last column
+  // @param page1 The last page
+  // @return true if success, false if error
+  bool send_window(uint8_t x0, uint8_t page0, uint8_t x1, uint8_t page1)
+  {
+    // the address pointer is already at the start of this window
+    if (is_window(m_state, x0, page0, x1, page1))
+    {
+      return true;
+    }
+
+    const std::array<uint8_t, 6> window{
+        static_cast<uint8_t>(acmd::set_column_address),
+        static_cast<uint8_t>(GEOMETRY::column_offset + x0),
+        static_cast<uint8_t>(GEOMETRY::column_offset + x1),
+        static_cast<uint8_t>(acmd::set_page_address),
+        page0,
+        page1,
+    };
+    if (!send_commands(window))
+    {
+      m_state.window_first_col = ControllerState::unknown;
+      return false;
+    }
+    set_window_state(m_state, x0, page0, x1, page1);
     return true;
   }
+
+  // @brief Check if a window is the current Horizontal Addressing Mode window
+  // @param state The IC register values
+  // @return true if setting the window would change nothing
+  static bool is_window(const ControllerState &state, uint8_t x0, uint8_t page0, uint8_t x1, uint8_t page1)
+  {
+    return state.window_first_col == GEOMETRY::column_offset + x0 && state.window_last_col == GEOMETRY::column_offset + x1 &&
+           state.window_first_page == page0 && state.window_last_page == page1;
+  }
+
+  // @brief Record a new Horizontal Addressing Mode window
+  // @param state The IC register values to update
+  static void set_window_state(ControllerState &state, uint8_t x0, uint8_t page0, uint8_t x1, uint8_t page1)
+  {
+    state.window_first_col  = GEOMETRY::column_offset + x0;
+    state.window_last_col   = GEOMETRY::column_offset + x1;
+    state.window_first_page = page0;
+    state.window_last_page  = page1;
+  }
+
+  // @brief Build the commands that move the Page Addressing Mode pointer to a page and column.
+  // Commands that would not change the pointer are left out.
+  // @param state The IC register values
+  // @param page_idx The GDDRAM page
+  // @param first_col The column
+  // @param preamble The commands
+  // @return uint8_t the number of commands, 0-3
+  static uint8_t page_preamble(const ControllerState &state, uint8_t page_idx, uint8_t first_col, std::array<uint8_t, 3> &preamble)
+  {
+    // the panel may not start at GDDRAM column 0
+    const uint8_t gddram_col = GEOMETRY::column_offset + first_col;
+    const bool column_known  = state.column != ControllerState::unknown;
+
+    uint8_t count{0};
+    if (state.page != page_idx)
+    {
+      preamble[count++] = static_cast<uint8_t>(acmd::start_page_0) + page_idx;
+    }
+    if (!column_known || (state.column & 0x0F) != (gddram_col & 0x0F))
+    {
+      preamble[count++] = static_cast<uint8_t>(acmd::start_lcol_0) | (gddram_col & 0x0F);
+    }
+    if (!column_known || (state.column >> 4) != (gddram_col >> 4))
+    {
+      preamble[count++] = static_cast<uint8_t>(acmd::start_hcol_0) | (gddram_col >> 4);
+    }
+    return count;
+  }
+
+  // @brief Record the Page Addressing Mode pointer after writing a column range. The column auto-increments;
+  // its position after the last GDDRAM column is not relied on.
+  // @param state The IC register values to update
+  static void advance_page_pointer(ControllerState &state, uint8_t page_idx, uint8_t last_col)
+  {
+    const uint16_t next_col = GEOMETRY::column_offset + last_col + 1;
+    state.page              = page_idx;
+    state.column            = (next_col > 127) ? ControllerState::unknown : static_cast<uint8_t>(next_col);
+  }
+
+  // @brief Send a column range of one page in Horizontal Addressing Mode: the window commands, then the data
+  // @param page_idx The GDDRAM page
+  // @param first_col The first column
+  // @param last_col The last column
+  // @return ErrorStatus
+  ErrorStatus send_window_span(uint8_t page_idx, uint8_t first_col, uint8_t last_col)
+  {
+    if (!send_window(first_col, page_idx, last_col, page_idx))
+    {
+      return ErrorStatus::START_PAGE_ERR;
+    }
+
+    if (!send_page_data(m_page_width * page_idx + first_col, last_col - first_col + 1))
+    {
+      return ErrorStatus::SEND_DATA_ERR;
+    }
+    return ErrorStatus::OK;
+  }
+
+  // @brief Send a column range of one page in Page Addressing Mode: the page and column commands, then the data
+  // @param page_idx The GDDRAM page
+  // @param first_col The first column
+  // @param last_col The last column
+  // @return ErrorStatus
+  ErrorStatus send_page_span(uint8_t page_idx, uint8_t first_col, uint8_t last_col)
+  {
+    // Set Page position to write to, then the lower (00h~0Fh) and upper (10h~1Fh) start column address
+    std::array<uint8_t, 3> preamble{};
+    const uint8_t count = page_preamble(m_state, page_idx, first_col, preamble);
+    if (count > 0 && !send_commands(preamble.data(), count))
+    {
+      m_state.page = ControllerState::unknown;
+      return ErrorStatus::START_PAGE_ERR;
+    }
+    advance_page_pointer(m_state, page_idx, last_col);
+
+    // the position of the first column within the GDDRAM buffer
+    const uint16_t page_pos_gddram{static_cast<uint16_t>(m_page_width * page_idx + first_col)};
+
+    if (!send_page_data(page_pos_gddram, last_col - first_col + 1))
+    {
+      return ErrorStatus::SEND_DATA_ERR;
+    }
+    return ErrorStatus::OK;
+  }
+
+  // @brief Send one command over SPI
+  // @param cmd_byte The byte to send
+  // @return true if success, false if error
+  bool send_command(uint8_t cmd_byte) { return send_commands(std::array<uint8_t, 1>{cmd_byte}); }
+
+  // @brief send (part of) one page of the display buffer in one burst, see TRANSPORT::send_data()
+  // @param page_pos_gddram The index position of the first byte within the buffer
+  // @param length The number of bytes to send. Must not cross the end of the page.
+  // @return true if success, false if error
+  bool send_page_data(uint16_t page_pos_gddram, uint16_t length)
+  {
+    observe_data(m_buffer.data() + page_pos_gddram, length);
+    return m_transport.send_data(m_buffer.data() + page_pos_gddram, length);
+  }
 };
 
 // Out-of-class definitions of member function templates
 
-template <typename DEVICE_ISR_ENUM>
-template <std::size_t FONT_SIZE, std::size_t MSG_SIZE>
-ErrorStatus Driver<DEVICE_ISR_ENUM>::write(noarch::containers::StaticString<MSG_SIZE> &msg,
-                                           Font<FONT_SIZE> &font,
+template <typename DEVICE_ISR_ENUM, typename GEOMETRY, std::size_t FRAMEBUFFER_COUNT, typename TRANSPORT>
+template <typename FONT, std::size_t MSG_SIZE>
+ErrorStatus Driver<DEVICE_ISR_ENUM, GEOMETRY, FRAMEBUFFER_COUNT, TRANSPORT>::write(noarch::containers::StaticString<MSG_SIZE> &msg,
+                                           const FONT &font,
                                            uint8_t x,
                                            uint8_t y,
                                            Colour bg [[maybe_unused]],
@@ -579,13 +1682,14 @@ ErrorStatus Driver<DEVICE_ISR_ENUM>::write(noarch::containers::StaticString<MSG_
                                            bool padding,
                                            bool update)
 {
+  trace::TraceScope scope{trace::TracePoint::write};
   // invalid cursor position requested
   if (!set_cursor(x, y))
   {
     return ErrorStatus::CURSOR_OOB;
   }
 
-  ErrorStatus write_res = write_string(msg, font, fg, padding);
+  ErrorStatus write_res = this->write_string(msg, font, fg, padding);
   if (write_res != ErrorStatus::OK)
   {
     return write_res;
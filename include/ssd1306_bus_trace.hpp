@@ -0,0 +1,350 @@
+// MIT License
+
+// Copyright (c) 2022 Chris Sutton
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __SSD1306_BUS_TRACE_HPP__
+#define __SSD1306_BUS_TRACE_HPP__
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <ssd1306_critical_section.hpp>
+
+#if defined(X86_UNIT_TESTING_ONLY)
+  #include <cstdio>
+#endif
+
+namespace ssd1306
+{
+
+// Bus trace format. Every byte sent to the IC, with its DC state and a timestamp, in a compact binary stream:
+//  - header: the 4 characters "SDBT" and a version byte
+//  - records: a BusRecordType byte, the clock ticks since the previous record, then
+//    - commands and data: the number of bytes and the bytes, as sent with DC low or high
+//    - frame: nothing more. Marks the end of a frame, see Driver::bus_statistics() for what counts as a frame.
+// Counts and ticks are unsigned LEB128: 7 bits per byte, least significant first, the MSB set on all but the last byte.
+
+// @brief The first bytes of a bus trace
+constexpr std::array<uint8_t, 5> bus_trace_header{'S', 'D', 'B', 'T', 1};
+
+enum class BusRecordType : uint8_t
+{
+  commands,
+  data,
+  frame
+};
+
+// @brief Timestamps the bus trace records, e.g. a free running timer
+using BusTraceClock = uint32_t (*)();
+
+// @brief RAM sink for a BusRecorder, for the target. The trace is drained with read(), e.g. over RTT or by a debugger.
+// A record that does not fit is dropped whole, so the trace read out is always well formed.
+// The Driver records from the application and from the DMA and SPI interrupts, so write() runs in a CriticalSection.
+// There is one reader, which may run concurrently with the writers without taking the lock.
+// @tparam SIZE The buffer size in bytes, a power of two
+template <std::size_t SIZE>
+class BusTraceRing
+{
+  static_assert(SIZE > 0 && (SIZE & (SIZE - 1)) == 0, "The bus trace ring size must be a power of two");
+
+public:
+  // @brief Append one record
+  // @param header The record header
+  // @param header_length
+  // @param payload The bytes sent, or nullptr
+  // @param payload_length
+  // @return true if the record was stored, false if it was dropped
+  bool write(const uint8_t *header, std::size_t header_length, const uint8_t *payload, std::size_t payload_length)
+  {
+    CriticalSection critical_section;
+    const uint32_t head = m_head.load(std::memory_order_relaxed);
+    if (SIZE - (head - m_tail.load(std::memory_order_acquire)) < header_length + payload_length)
+    {
+      m_dropped++;
+      return false;
+    }
+    copy_in(head, header, header_length);
+    copy_in(head + header_length, payload, payload_length);
+    m_head.store(head + header_length + payload_length, std::memory_order_release);
+    return true;
+  }
+
+  // @brief Take the oldest bytes
+  // @param bytes The destination
+  // @param max_length The size of the destination
+  // @return std::size_t the number of bytes taken
+  std::size_t read(uint8_t *bytes, std::size_t max_length)
+  {
+    const uint32_t tail   = m_tail.load(std::memory_order_relaxed);
+    const uint32_t length = std::min<uint32_t>(m_head.load(std::memory_order_acquire) - tail, max_length);
+    for (uint32_t idx = 0; idx < length; idx++)
+    {
+      bytes[idx] = m_bytes[(tail + idx) & (SIZE - 1)];
+    }
+    m_tail.store(tail + length, std::memory_order_release);
+    return length;
+  }
+
+  // @brief The number of bytes waiting to be read
+  std::size_t size() const { return m_head.load() - m_tail.load(); }
+
+  // @brief The number of records that did not fit
+  uint32_t dropped() const { return m_dropped; }
+
+private:
+  std::array<uint8_t, SIZE> m_bytes{};
+
+  // @brief The number of bytes ever written
+  std::atomic<uint32_t> m_head{0};
+
+  // @brief The number of bytes ever read
+  std::atomic<uint32_t> m_tail{0};
+
+  uint32_t m_dropped{0};
+
+  void copy_in(uint32_t pos, const uint8_t *bytes, std::size_t length)
+  {
+    for (std::size_t idx = 0; idx < length; idx++)
+    {
+      m_bytes[(pos + idx) & (SIZE - 1)] = bytes[idx];
+    }
+  }
+};
+
+#if defined(X86_UNIT_TESTING_ONLY)
+// @brief File sink for a BusRecorder, for the host
+class BusTraceFile
+{
+public:
+  // @param file An open binary file. Not closed by BusTraceFile.
+  explicit BusTraceFile(std::FILE *file)
+      : m_file(file)
+  {
+  }
+
+  // @brief Append one record, see BusTraceRing::write()
+  bool write(const uint8_t *header, std::size_t header_length, const uint8_t *payload, std::size_t payload_length)
+  {
+    return std::fwrite(header, 1, header_length, m_file) == header_length &&
+           (payload_length == 0 || std::fwrite(payload, 1, payload_length, m_file) == payload_length);
+  }
+
+private:
+  std::FILE *m_file;
+};
+#endif
+
+// @brief Encodes the bus traffic of a Driver as bus trace records, see RecordingTransport.
+// @tparam SINK Stores the records: BusTraceRing, BusTraceFile or any class with the same write() member
+template <typename SINK>
+class BusRecorder
+{
+public:
+  // @param sink Stores the records. Must outlive the recorder.
+  // @param clock Timestamps the records. Without a clock all timestamps are 0.
+  explicit BusRecorder(SINK &sink, BusTraceClock clock = nullptr)
+      : m_sink(sink),
+        m_clock(clock)
+  {
+  }
+
+  // @brief Record a burst of command bytes
+  void commands(const uint8_t *cmd_bytes, std::size_t count) { write_record(BusRecordType::commands, cmd_bytes, count); }
+
+  // @brief Record a burst or DMA transfer of data bytes
+  void data(const uint8_t *data_bytes, std::size_t length) { write_record(BusRecordType::data, data_bytes, length); }
+
+  // @brief Mark the end of a frame. Nothing is recorded if nothing was sent since the last frame.
+  void frame()
+  {
+    CriticalSection critical_section;
+    if (m_frame_open)
+    {
+      write_record(BusRecordType::frame, nullptr, 0);
+      m_frame_open = false;
+    }
+  }
+
+private:
+  SINK &m_sink;
+  BusTraceClock m_clock;
+
+  // @brief The timestamp of the last record stored
+  uint32_t m_last_timestamp{0};
+
+  // @brief The header has been stored
+  bool m_started{false};
+
+  // @brief Bytes were sent since the last frame record
+  bool m_frame_open{false};
+
+  // @brief Append an unsigned LEB128 value
+  // @return std::size_t the position after the value
+  template <std::size_t SIZE>
+  static std::size_t put_varint(std::array<uint8_t, SIZE> &bytes, std::size_t pos, uint32_t value)
+  {
+    while (value >= 0x80)
+    {
+      bytes[pos++] = static_cast<uint8_t>(value | 0x80);
+      value >>= 7;
+    }
+    bytes[pos++] = static_cast<uint8_t>(value);
+    return pos;
+  }
+
+  // Runs in a CriticalSection: the timestamp delta is taken against the last record stored, so reading the clock and
+  // storing the record must not be interleaved with a record from an interrupt.
+  void write_record(BusRecordType type, const uint8_t *payload, std::size_t length)
+  {
+    CriticalSection critical_section;
+    // trace header, type, 5 byte ticks and 5 byte count
+    std::array<uint8_t, bus_trace_header.size() + 11> header;
+    std::size_t pos{0};
+    if (!m_started)
+    {
+      for (uint8_t byte : bus_trace_header)
+      {
+        header[pos++] = byte;
+      }
+    }
+    const uint32_t timestamp = (m_clock != nullptr) ? m_clock() : 0;
+    header[pos++]            = static_cast<uint8_t>(type);
+    pos                      = put_varint(header, pos, timestamp - m_last_timestamp);
+    if (type != BusRecordType::frame)
+    {
+      pos          = put_varint(header, pos, static_cast<uint32_t>(length));
+      m_frame_open = true;
+    }
+    if (m_sink.write(header.data(), pos, payload, length))
+    {
+      m_started        = true;
+      m_last_timestamp = timestamp;
+    }
+  }
+};
+
+// @brief Transport policy that records the bus traffic of a Driver while sending it with another transport.
+// The Driver passes every burst to record_commands() and record_data() wherever it is sent from: the CPU, DMA or the
+// SPI interrupt, and calls record_frame() when a frame completes.
+// @tparam TRANSPORT The transport that sends the bytes, see ssd1306_transport.hpp
+// @tparam SINK The BusRecorder sink
+template <typename TRANSPORT, typename SINK>
+class RecordingTransport : public TRANSPORT
+{
+public:
+  // @param transport The transport that sends the bytes
+  // @param recorder Encodes the traffic. Must outlive the Driver.
+  RecordingTransport(const TRANSPORT &transport, BusRecorder<SINK> &recorder)
+      : TRANSPORT(transport),
+        m_recorder(&recorder)
+  {
+  }
+
+  void record_commands(const uint8_t *cmd_bytes, std::size_t count) { m_recorder->commands(cmd_bytes, count); }
+
+  void record_data(const uint8_t *data_bytes, std::size_t length) { m_recorder->data(data_bytes, length); }
+
+  void record_frame() { m_recorder->frame(); }
+
+private:
+  BusRecorder<SINK> *m_recorder;
+};
+
+// @brief One record of a bus trace, see BusTraceReader
+struct BusTraceRecord
+{
+  BusRecordType type{BusRecordType::frame};
+  // @brief The clock ticks since the start of the trace, wrapping
+  uint32_t timestamp{0};
+  // @brief The bytes sent. Points into the trace.
+  std::span<const uint8_t> bytes{};
+};
+
+// @brief Decodes a bus trace
+class BusTraceReader
+{
+public:
+  // @param trace The whole trace, starting with the header
+  explicit BusTraceReader(std::span<const uint8_t> trace)
+      : m_trace(trace)
+  {
+    m_valid = m_trace.size() >= bus_trace_header.size() && std::equal(bus_trace_header.begin(), bus_trace_header.end(), m_trace.begin());
+    m_pos   = bus_trace_header.size();
+  }
+
+  // @brief Take the next record
+  // @param record The record
+  // @return true if there was a record, false at the end of the trace or if it is malformed, see valid()
+  bool next(BusTraceRecord &record)
+  {
+    if (!m_valid || m_pos == m_trace.size())
+    {
+      return false;
+    }
+    uint32_t ticks{0};
+    uint32_t length{0};
+    const auto type = static_cast<BusRecordType>(m_trace[m_pos++]);
+    m_valid         = type <= BusRecordType::frame && get_varint(ticks);
+    if (m_valid && type != BusRecordType::frame)
+    {
+      m_valid = get_varint(length) && length <= m_trace.size() - m_pos;
+    }
+    if (!m_valid)
+    {
+      return false;
+    }
+    m_timestamp += ticks;
+    record = BusTraceRecord{type, m_timestamp, m_trace.subspan(m_pos, length)};
+    m_pos += length;
+    return true;
+  }
+
+  // @brief The trace has the bus trace header and every record read so far was complete
+  bool valid() const { return m_valid; }
+
+private:
+  std::span<const uint8_t> m_trace;
+  std::size_t m_pos{0};
+  uint32_t m_timestamp{0};
+  bool m_valid{false};
+
+  bool get_varint(uint32_t &value)
+  {
+    value = 0;
+    for (uint8_t shift = 0; shift < 35 && m_pos < m_trace.size(); shift += 7)
+    {
+      const uint8_t byte = m_trace[m_pos++];
+      value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+      if (!(byte & 0x80))
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+} // namespace ssd1306
+
+#endif // __SSD1306_BUS_TRACE_HPP__
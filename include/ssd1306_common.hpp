@@ -23,8 +23,11 @@
 #ifndef __SSD1306_COMMON_HPP__
 #define __SSD1306_COMMON_HPP__
 
+#include <algorithm>
 #include <font.hpp>
 #include <isr_manager_stm32g0.hpp>
+#include <span>
+#include <ssd1306_trace.hpp>
 #include <static_string.hpp>
 
 #ifndef X86_UNIT_TESTING_ONLY
@@ -66,14 +69,108 @@ enum class ErrorStatus
   START_HCOL_ERR,
   // @brief error sending buffer data command to SSD1306
   SEND_DATA_ERR,
+  // @brief the previous DMA frame transfer has not completed
+  DMA_BUSY,
+  // @brief error sending a command to SSD1306
+  SEND_CMD_ERR,
+  // @brief GDDRAM can't be written while the IC is scrolling, see Driver::start_scroll()
+  SCROLLING,
   // @brief bad things happened here
   UNKNOWN_ERR
 };
 
+#if defined(SSD1306_BUS_STATISTICS)
+// @brief Bus traffic counters, see Driver::bus_statistics()
+struct BusCounters
+{
+  // @brief bytes sent with DC low, or as I2C commands
+  uint32_t command_bytes{0};
+  // @brief bytes sent with DC high, or as I2C data
+  uint32_t data_bytes{0};
+  // @brief changes between command and data mode
+  uint32_t dc_toggles{0};
+  // @brief polls of the SPI TXE flag before queueing a byte
+  uint32_t txe_waits{0};
+  // @brief polls of the SPI BSY flag before changing DC or finishing
+  uint32_t bsy_waits{0};
+  // @brief bursts, DMA transfers and interrupt driven page streams
+  uint32_t transfers{0};
+
+  BusCounters &operator+=(const BusCounters &other)
+  {
+    command_bytes += other.command_bytes;
+    data_bytes += other.data_bytes;
+    dc_toggles += other.dc_toggles;
+    txe_waits += other.txe_waits;
+    bsy_waits += other.bsy_waits;
+    transfers += other.transfers;
+    return *this;
+  }
+};
+
+// @brief Per-frame and cumulative bus cost. Compiled in with SSD1306_BUS_STATISTICS.
+struct BusStatistics
+{
+  // @brief The last completed frame, including any traffic since the frame before it e.g. settings
+  BusCounters frame;
+  // @brief All completed frames
+  BusCounters total;
+  // @brief The number of completed frames
+  uint32_t frames{0};
+  // @brief Frame transfer times from the update call to the end of the transfer, in Driver::StatisticsClock ticks
+  uint32_t last_frame_ticks{0};
+  uint32_t min_frame_ticks{UINT32_MAX};
+  uint32_t max_frame_ticks{0};
+};
+#endif
+
+// @brief The resolution of an SSD1306 panel and the hardware configuration the IC needs to drive it.
+// @tparam WIDTH The number of columns on the panel, 1-128
+// @tparam HEIGHT The number of rows on the panel, a multiple of 8 from 16 to 64
+// @tparam COM_PIN_CFG The COM pins hardware configuration byte, see section 10.1.18 of datasheet
+// @tparam COLUMN_OFFSET The first GDDRAM column wired to the panel. Panels narrower than 128 columns are centered.
+template <uint8_t WIDTH, uint8_t HEIGHT, uint8_t COM_PIN_CFG, uint8_t COLUMN_OFFSET = 0>
+struct Geometry
+{
+  static_assert(WIDTH > 0 && WIDTH + COLUMN_OFFSET <= 128, "The panel must fit within the 128 GDDRAM columns");
+  static_assert(HEIGHT >= 16 && HEIGHT <= 64 && HEIGHT % 8 == 0, "The panel height must be whole GDDRAM pages, 16-64 rows");
+
+  // @brief The number of columns on the panel
+  static constexpr uint8_t width{WIDTH};
+  // @brief The number of rows on the panel
+  static constexpr uint8_t height{HEIGHT};
+  // @brief The COM pins hardware configuration byte
+  static constexpr uint8_t com_pin_cfg{COM_PIN_CFG};
+  // @brief The first GDDRAM column wired to the panel
+  static constexpr uint8_t column_offset{COLUMN_OFFSET};
+  // @brief The multiplex ratio byte, the number of COM lines used minus one
+  static constexpr uint8_t mux_ratio{HEIGHT - 1};
+};
+
+// @brief 0.96" 128x64 module. Alternative COM config.
+using Geometry128x64 = Geometry<128, 64, 0x12>;
+// @brief 0.91" 128x32 module. Sequential COM config.
+using Geometry128x32 = Geometry<128, 32, 0x02>;
+// @brief 0.42" 72x40 module, wired to GDDRAM columns 28-99
+using Geometry72x40 = Geometry<72, 40, 0x12, 28>;
+// @brief 0.66" 64x48 module, wired to GDDRAM columns 32-95
+using Geometry64x48 = Geometry<64, 48, 0x12, 32>;
+
+// @brief The sw buffer and the drawing functions. Sized at compile time for the panel.
+// @tparam GEOMETRY The panel resolution, see Geometry
+// @tparam FRAMEBUFFER_COUNT The number of sw buffers. With 2 or 3 the application draws to one while another is sent.
+template <typename GEOMETRY = Geometry128x64, std::size_t FRAMEBUFFER_COUNT = 1>
 class CommonFunctions
 {
+  static_assert(FRAMEBUFFER_COUNT >= 1 && FRAMEBUFFER_COUNT <= 3, "Single, double or triple buffering only");
 
 public:
+  CommonFunctions() = default;
+
+  // @brief Not copyable or movable, m_buffer points into this object's own m_framebuffers
+  CommonFunctions(const CommonFunctions &)            = delete;
+  CommonFunctions &operator=(const CommonFunctions &) = delete;
+
   // @brief X coordinate for writing to the display
   uint16_t m_currentx{0};
 
@@ -81,17 +178,45 @@ public:
   uint16_t m_currenty{0};
 
   // @brief The display width in bytes. Also the size of each GDDRAM page
-  static const uint16_t m_page_width{128};
+  static constexpr uint16_t m_page_width{GEOMETRY::width};
+
+  // @brief The display height, in bytes. Also the number of pages multiplied by the bits per page column (8)
+  static constexpr uint16_t m_height{GEOMETRY::height};
+
+  // @brief The number of GDDRAM pages. Each page holds 8 rows of the display.
+  static constexpr uint16_t m_page_count{m_height / 8};
+
+  // @brief The size of each sw buffer in bytes
+  static constexpr std::size_t m_buffer_size{(m_page_width * m_height) / 8};
+
+  // @brief The number of sw buffers
+  static constexpr std::size_t m_framebuffer_count{FRAMEBUFFER_COUNT};
 
-  // @brief The display height, in bytes. Also the number of pages (8) multiplied by the bits per page column (8)
-  static const uint16_t m_height{64};
+protected:
+  // @brief The sw buffers. m_buffer refers to one of these.
+  std::array<std::array<uint8_t, m_buffer_size>, FRAMEBUFFER_COUNT> m_framebuffers{};
+
+public:
+  // @brief byte buffer for ssd1306, the back buffer when double or triple buffering. All drawing goes here.
+  // Access to derived classes like ssd1306_tester is permitted.
+  std::span<uint8_t, m_buffer_size> m_buffer{m_framebuffers[0]};
 
-  // @brief byte buffer for ssd1306. Access to derived classes like ssd1306_tester is permitted.
-  std::array<uint8_t, (m_page_width * m_height) / 8> m_buffer;
+  // @brief The range of columns within a GDDRAM page that have changed since the last update.
+  // The page is clean when first > last.
+  struct DirtySpan
+  {
+    uint8_t first{0xFF};
+    uint8_t last{0x00};
+  };
 
   // @brief Write single colour to entire sw buffer
   // @param colour
-  void fill(Colour colour);
+  void fill(Colour colour)
+  {
+    trace::TraceScope scope{trace::TracePoint::fill};
+    std::fill(m_buffer.begin(), m_buffer.end(), (colour == Colour::Black) ? 0x00 : 0xFF);
+    mark_all_dirty();
+  }
 
   // @brief Write a pixel to the sw buffer at the corresponding display coordinates
   // @param x pos
@@ -104,107 +229,245 @@ public:
   // @param y
   bool set_cursor(uint8_t x, uint8_t y);
 
+  // @brief Add a range of columns to the modified area of a GDDRAM page.
+  // Call this after writing to m_buffer directly so the next update transmits the change.
+  // @param page the GDDRAM page
+  // @param first_col the first modified column
+  // @param last_col the last modified column
+  void mark_dirty(uint8_t page, uint8_t first_col, uint8_t last_col)
+  {
+    DirtySpan &span = m_dirty_spans[page];
+    if (first_col < span.first)
+    {
+      span.first = first_col;
+    }
+    if (last_col > span.last)
+    {
+      span.last = last_col;
+    }
+  }
+
+  // @brief Mark every column of every page as modified
+  void mark_all_dirty() { m_dirty_spans.fill(DirtySpan{0, m_page_width - 1}); }
+
+  // @brief Mark every page as unmodified
+  void clear_dirty() { m_dirty_spans.fill(DirtySpan{}); }
+
+  // @brief Get the modified column range of a GDDRAM page
+  // @param page the GDDRAM page
+  // @return const DirtySpan& the column range. The page is clean when first > last.
+  const DirtySpan &dirty_span(uint8_t page) { return m_dirty_spans[page]; }
+
+  // @brief Check if a GDDRAM page has been modified since the last update
+  // @param page the GDDRAM page
+  // @return true if the page needs to be sent to the IC
+  bool is_dirty(uint8_t page) { return m_dirty_spans[page].first <= m_dirty_spans[page].last; }
+
 protected:
-  template <std::size_t FONT_SIZE, std::size_t MSG_SIZE>
-  ErrorStatus write_string(noarch::containers::StaticString<MSG_SIZE> &msg, Font<FONT_SIZE> &font, Colour colour, bool padding);
+  // @brief The modified column range of each GDDRAM page
+  std::array<DirtySpan, m_page_count> m_dirty_spans;
+
+  // @brief Write a string to the sw buffer at the current cursor position
+  // @tparam FONT The font type: a Font or a ProportionalFont
+  // @tparam MSG_SIZE
+  // @param msg
+  // @param font
+  // @param colour
+  // @param padding add an extra pixel to the vertical edge of the character. Disables kerning.
+  // @return ErrorStatus PIXEL_OOB if the font has no glyph for a character
+  template <typename FONT, std::size_t MSG_SIZE>
+  ErrorStatus write_string(noarch::containers::StaticString<MSG_SIZE> &msg, const FONT &font, Colour colour, bool padding);
 
-  // @brief
-  // @tparam FONT_SIZE
+  // @brief Write a character to the sw buffer at the current cursor position and advance the cursor
+  // @tparam FONT The font type: a Font or a ProportionalFont
   // @param ch
   // @param font
   // @param colour
   // @param padding
+  // @param overlap the number of leading columns that overlap the previous character after kerning.
+  // Only the foreground pixels of these columns are written.
   // @return ErrorStatus
-  template <std::size_t FONT_SIZE>
-  ErrorStatus write_char(char ch, Font<FONT_SIZE> &font, Colour colour, bool padding);
+  template <typename FONT>
+  ErrorStatus write_char(char ch, const FONT &font, Colour colour, bool padding, uint8_t overlap = 0);
+
+  // @brief Write a vertical run of pixels to the sw buffer as whole bytes, one read-modify-write per GDDRAM page.
+  // Runs that don't start on a page boundary are shifted and split across two or more pages.
+  // Does not update the dirty spans.
+  // @param x the column
+  // @param y the top row of the run
+  // @param height the number of rows in the run, 1-32
+  // @param bits the pixel values, LSB is the top row. Set bits are white.
+  void blit_column(uint8_t x, uint8_t y, uint8_t height, uint32_t bits)
+  {
+    blit_column_masked(x, y, bits, (height >= 32) ? 0xFFFFFFFF : ((1U << height) - 1));
+  }
+
+  // @brief Write selected pixels of a vertical run to the sw buffer as whole bytes. See blit_column().
+  // @param x the column
+  // @param y the top row of the run
+  // @param bits the pixel values, LSB is the top row. Set bits are white.
+  // @param mask the pixels to write, LSB is the top row. The other pixels are unchanged.
+  void blit_column_masked(uint8_t x, uint8_t y, uint32_t bits, uint32_t mask);
 };
 
-template <std::size_t FONT_SIZE, std::size_t MSG_SIZE>
-ErrorStatus CommonFunctions::write_string(noarch::containers::StaticString<MSG_SIZE> &msg, Font<FONT_SIZE> &font, Colour colour, bool padding)
+template <typename GEOMETRY, std::size_t FRAMEBUFFER_COUNT>
+void CommonFunctions<GEOMETRY, FRAMEBUFFER_COUNT>::draw_pixel(uint8_t x, uint8_t y, Colour colour)
+{
+  // Draw in the right color
+  if (colour == Colour::White)
+  {
+    m_buffer[x + (y / 8) * m_page_width] |= 1 << (y % 8);
+#ifdef ENABLE_SSD1306_TEST_STDOUT
+    std::cout << "1";
+#endif
+  }
+  else
+  {
+    m_buffer[x + (y / 8) * m_page_width] &= ~(1 << (y % 8));
+#ifdef ENABLE_SSD1306_TEST_STDOUT
+    std::cout << "_";
+#endif
+  }
+  mark_dirty(y / 8, x, x);
+}
+
+template <typename GEOMETRY, std::size_t FRAMEBUFFER_COUNT>
+bool CommonFunctions<GEOMETRY, FRAMEBUFFER_COUNT>::set_cursor(uint8_t x, uint8_t y)
+{
+  if (x >= m_page_width || y >= m_height)
+  {
+    return false;
+  }
+  else
+  {
+    m_currentx = x;
+    m_currenty = y;
+  }
+  return true;
+}
+
+template <typename GEOMETRY, std::size_t FRAMEBUFFER_COUNT>
+void CommonFunctions<GEOMETRY, FRAMEBUFFER_COUNT>::blit_column_masked(uint8_t x, uint8_t y, uint32_t bits, uint32_t mask)
+{
+  const uint8_t shift = y % 8;
+  uint8_t *dest       = &m_buffer[x + (y / 8) * m_page_width];
+
+  // first page: the run starts `shift` rows down from the top of the page
+  uint8_t page_mask = static_cast<uint8_t>(mask << shift);
+  *dest             = (*dest & ~page_mask) | (static_cast<uint8_t>(bits << shift) & page_mask);
+  mask >>= (8 - shift);
+  bits >>= (8 - shift);
+
+  // remaining pages: whole bytes, the last one may be partial
+  while (mask != 0)
+  {
+    dest += m_page_width;
+    page_mask = static_cast<uint8_t>(mask);
+    *dest     = (*dest & ~page_mask) | (static_cast<uint8_t>(bits) & page_mask);
+    mask >>= 8;
+    bits >>= 8;
+  }
+}
+
+template <typename GEOMETRY, std::size_t FRAMEBUFFER_COUNT>
+template <typename FONT, std::size_t MSG_SIZE>
+ErrorStatus CommonFunctions<GEOMETRY, FRAMEBUFFER_COUNT>::write_string(noarch::containers::StaticString<MSG_SIZE> &msg, const FONT &font, Colour colour, bool padding)
 {
+  trace::TraceScope scope{trace::TracePoint::write_string};
+  char previous{0};
+
   // Write until null-byte
   for (char &c : msg.array())
   {
-    ErrorStatus res = write_char(c, font, colour, padding);
+    if (c == '\0')
+    {
+      break;
+    }
+
+    // move the cursor by the kerning between this character and the previous one
+    uint8_t overlap{0};
+    if (!padding && previous != 0)
+    {
+      const int8_t adjust = font.kerning(previous, c);
+      if (adjust < 0)
+      {
+        overlap = (m_currentx < -adjust) ? m_currentx : -adjust;
+        m_currentx -= overlap;
+      }
+      else
+      {
+        m_currentx += adjust;
+      }
+    }
+
+    ErrorStatus res = write_char(c, font, colour, padding, overlap);
     if (res != ErrorStatus::OK)
     {
       return res;
     }
+    previous = c;
   }
   return ErrorStatus::OK;
 }
 
-template <std::size_t FONT_SIZE>
-ErrorStatus CommonFunctions::write_char(char ch, Font<FONT_SIZE> &font, Colour colour, bool padding)
+template <typename GEOMETRY, std::size_t FRAMEBUFFER_COUNT>
+template <typename FONT>
+ErrorStatus CommonFunctions<GEOMETRY, FRAMEBUFFER_COUNT>::write_char(char ch, const FONT &font, Colour colour, bool padding, uint8_t overlap)
 {
+  trace::TraceScope scope{trace::TracePoint::write_char};
+  // the one range check per glyph, the glyph accessors below are unchecked
+  const std::size_t glyph_idx = font.glyph_index(ch);
+  if (glyph_idx == no_glyph)
+  {
+    return ErrorStatus::PIXEL_OOB;
+  }
+
+  // inked columns are followed by background columns up to the advance (proportional fonts only)
+  const uint8_t glyph_width = font.glyph_width(glyph_idx);
+  const uint8_t advance     = font.glyph_advance(glyph_idx);
+
+  // the leading padding column is drawn, the trailing one is only skipped
+  const uint8_t drawn_width = advance + (padding ? 1 : 0);
 
   // Check remaining space on current line
-  if (m_page_width <= (m_currentx + font.height()) || m_page_width <= (m_currenty + font.height()))
+  if (m_page_width < (m_currentx + drawn_width) || m_height < (m_currenty + font.height()))
   {
     // Not enough space on current line
     return ErrorStatus::OK;
   }
 
+  // the glyph rectangle is about to change on every page it covers
+  for (uint8_t page = m_currenty / 8; page <= (m_currenty + font.height() - 1) / 8; page++)
+  {
+    mark_dirty(page, m_currentx, m_currentx + drawn_width - 1);
+  }
+
   // add extra leading horizontal space
   if (padding)
   {
-    for (size_t n = 0; n < font.height(); n++)
-    {
-      draw_pixel(m_currentx, (m_currenty + n), Colour::Black);
-    }
+    blit_column(m_currentx, m_currenty, font.height(), 0);
     m_currentx += 1;
   }
 
-  // Use the font to write
-  uint32_t font_data_word{0};
-  for (size_t font_height_idx = 0; font_height_idx < font.height(); font_height_idx++)
+  // set bits are foreground pixels, clear bits are background pixels. The glyph pixels are decoded from the
+  // bit-packed columns, see FontPacked.
+  const uint32_t invert_mask = (colour == Colour::White) ? 0 : 0xFFFFFFFF;
+  for (uint8_t col = 0; col < advance; col++)
   {
-    if (!font.get_pixel((ch - 32) * 7 + font_height_idx, font_data_word))
+    const uint32_t glyph_column = (col < glyph_width) ? font.column(glyph_idx, col) : 0;
+    if (col < overlap)
     {
-      return ErrorStatus::PIXEL_OOB;
+      // keep the previous character visible under the kerned columns
+      blit_column_masked(m_currentx + col, m_currenty, (colour == Colour::White) ? glyph_column : 0, glyph_column);
     }
-
-#ifdef ENABLE_SSD1306_TEST_STDOUT
-    // separator for the font
-    std::cout << std::endl;
-#endif
-
-    // get each bit/pixel in the font_data_word and write it to the display output buffer
-    for (size_t font_width_idx = 0; font_width_idx < font.width(); font_width_idx++)
+    else
     {
-      // shift left and check if MSB is set: write as foreground pixel
-      if ((font_data_word << font_width_idx) & 0x8000)
-      {
-        switch (colour)
-        {
-          case Colour::White:
-            draw_pixel(m_currentx + font_width_idx, m_currenty + font_height_idx, Colour::White);
-            break;
-
-          case Colour::Black:
-            draw_pixel(m_currentx + font_width_idx, m_currenty + font_height_idx, Colour::Black);
-            break;
-        }
-      }
-      // MSB is not set: write as background pixel
-      else
-      {
-        switch (colour)
-        {
-          case Colour::White:
-            draw_pixel(m_currentx + font_width_idx, m_currenty + font_height_idx, Colour::Black);
-            break;
-
-          case Colour::Black:
-            draw_pixel(m_currentx + font_width_idx, m_currenty + font_height_idx, Colour::White);
-            break;
-        }
-      }
+      blit_column(m_currentx + col, m_currenty, font.height(), glyph_column ^ invert_mask);
     }
   }
 
   // The current space is now taken
-  m_currentx += font.width();
+  m_currentx += advance;
 
   // add extra leading horizontal space
   if (padding)
@@ -0,0 +1,81 @@
+// MIT License
+
+// Copyright (c) 2022 Chris Sutton
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __SSD1306_CRITICAL_SECTION_HPP__
+#define __SSD1306_CRITICAL_SECTION_HPP__
+
+#include <cstdint>
+
+#if defined(X86_UNIT_TESTING_ONLY)
+  #include <mutex>
+#else
+  #include <stm32g0xx.h>
+#endif
+
+namespace ssd1306
+{
+
+// @brief Disables interrupts until it goes out of scope, then restores the previous PRIMASK, so it can be nested.
+// Cortex-M0+ has no LDREX/STREX, so std::atomic read-modify-write operations are library calls that bare-metal
+// toolchains don't provide (libatomic). State shared by the application and the ISRs is only ever loaded and stored
+// atomically; anything that reads and then writes it does so in a CriticalSection.
+// The x86 build has no interrupts and takes a process wide lock instead, so host threads are serialized the same way.
+class CriticalSection
+{
+public:
+  CriticalSection()
+  {
+#if defined(X86_UNIT_TESTING_ONLY)
+    lock().lock();
+#else
+    m_primask = __get_PRIMASK();
+    __disable_irq();
+#endif
+  }
+
+  ~CriticalSection()
+  {
+#if defined(X86_UNIT_TESTING_ONLY)
+    lock().unlock();
+#else
+    __set_PRIMASK(m_primask);
+#endif
+  }
+
+  CriticalSection(const CriticalSection &)            = delete;
+  CriticalSection &operator=(const CriticalSection &) = delete;
+
+private:
+#if defined(X86_UNIT_TESTING_ONLY)
+  static std::recursive_mutex &lock()
+  {
+    static std::recursive_mutex mutex;
+    return mutex;
+  }
+#else
+  uint32_t m_primask;
+#endif
+};
+
+} // namespace ssd1306
+
+#endif // __SSD1306_CRITICAL_SECTION_HPP__
@@ -45,16 +45,29 @@ public:
   // @param dc_pin        The data/command pin e.g. LL_GPIO_PIN_0
   // @param reset_port    The reset port e.g. GPIOA
   // @param reset_pin     The reset pin e.g. LL_GPIO_PIN_3
+  // @param dma_isr_type  The DMA channel interrupt e.g. STM32G0_ISR::dma1_ch1
   DriverSerialInterface(SPI_TypeDef *display_spi,
                         std::pair<GPIO_TypeDef *, uint16_t> dc_gpio,
                         std::pair<GPIO_TypeDef *, uint16_t> reset_gpio,
                         DEVICE_ISR_ENUM dma_isr_type)
+      : DriverSerialInterface(display_spi, dc_gpio, reset_gpio, dma_isr_type, dma_isr_type)
+  {
+  }
+
+  // @brief Construct a new ssd1306::DriverSerialInterface object, for Driver::SPIDMA::interrupt
+  // @param spi_isr_type  The SPI peripheral interrupt e.g. STM32G0_ISR::spi1
+  DriverSerialInterface(SPI_TypeDef *display_spi,
+                        std::pair<GPIO_TypeDef *, uint16_t> dc_gpio,
+                        std::pair<GPIO_TypeDef *, uint16_t> reset_gpio,
+                        DEVICE_ISR_ENUM dma_isr_type,
+                        DEVICE_ISR_ENUM spi_isr_type)
       : m_display_spi(*display_spi),
         m_dc_port(*dc_gpio.first),
         m_dc_pin(dc_gpio.second),
         m_reset_port(*reset_gpio.first),
         m_reset_pin(reset_gpio.second),
-        m_dma_isr_type(dma_isr_type)
+        m_dma_isr_type(dma_isr_type),
+        m_spi_isr_type(spi_isr_type)
   {
   }
   SPI_TypeDef &get_spi_handle() { return m_display_spi; }
@@ -63,6 +76,7 @@ public:
   GPIO_TypeDef &get_reset_port() { return m_reset_port; }
   uint16_t get_reset_pin() { return m_reset_pin; }
   DEVICE_ISR_ENUM get_dma_isr_type() { return m_dma_isr_type; }
+  DEVICE_ISR_ENUM get_spi_isr_type() { return m_spi_isr_type; }
 
 private:
   // @brief The SPI peripheral
@@ -77,6 +91,9 @@ private:
   uint16_t m_reset_pin;
 
   DEVICE_ISR_ENUM m_dma_isr_type;
+
+  // @brief Only used by Driver::SPIDMA::interrupt
+  DEVICE_ISR_ENUM m_spi_isr_type;
 };
 
 } // namespace ssd1306
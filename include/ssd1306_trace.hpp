@@ -0,0 +1,219 @@
+// MIT License
+
+// Copyright (c) 2022 Chris Sutton
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __SSD1306_TRACE_HPP__
+#define __SSD1306_TRACE_HPP__
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(SSD1306_TRACE)
+  #include <array>
+  #include <ssd1306_critical_section.hpp>
+  #if defined(X86_UNIT_TESTING_ONLY)
+    #include <chrono>
+  #endif
+#endif
+
+// @brief The number of trace records kept, a power of two
+#if !defined(SSD1306_TRACE_DEPTH)
+  #define SSD1306_TRACE_DEPTH 64
+#endif
+
+namespace ssd1306::trace
+{
+
+// @brief The traced functions
+enum class TracePoint : uint8_t
+{
+  write,
+  write_string,
+  write_char,
+  fill,
+  update_screen,
+  transfer_complete
+};
+
+enum class TracePhase : uint8_t
+{
+  begin,
+  end,
+  // @brief a single point in time, e.g. an interrupt
+  instant
+};
+
+// @brief One timestamped event
+struct TraceRecord
+{
+  // @brief CPU cycles on ARM, nanoseconds on x86, see now()
+  uint32_t timestamp{0};
+  TracePoint point{TracePoint::write};
+  TracePhase phase{TracePhase::begin};
+};
+
+#if defined(SSD1306_TRACE)
+
+// @brief Enable the cycle counter. Called by Driver::power_on_sequence().
+inline void enable_clock()
+{
+  #if !defined(X86_UNIT_TESTING_ONLY) && defined(DWT)
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  #endif
+}
+
+// @brief The current time.
+// Cortex-M3 and up count CPU cycles with the DWT cycle counter. Cortex-M0+ has no DWT cycle counter, so the
+// SysTick counter is used instead: it counts CPU cycles too, but wraps every SysTick period, so only intervals
+// shorter than one period are meaningful. The x86 build uses std::chrono::steady_clock in nanoseconds.
+// @return uint32_t the timestamp, wrapping
+inline uint32_t now()
+{
+  #if defined(X86_UNIT_TESTING_ONLY)
+  return static_cast<uint32_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+  #elif defined(DWT)
+  return DWT->CYCCNT;
+  #else
+  // SysTick counts down
+  return SysTick->LOAD - SysTick->VAL;
+  #endif
+}
+
+// @brief Fixed size ring of trace records. The newest records overwrite the oldest ones.
+// The draw code and the ISRs both record, so a slot is claimed and written in one CriticalSection: an atomic
+// increment alone would need libatomic on Cortex-M0+ and would let pop() read a record that is still being written.
+// A single reader drains it, see pop().
+// @tparam DEPTH The number of records, a power of two
+template <std::size_t DEPTH>
+class TraceBuffer
+{
+  static_assert(DEPTH > 0 && (DEPTH & (DEPTH - 1)) == 0, "The trace depth must be a power of two");
+
+public:
+  // @brief Timestamp and store an event
+  // @param point The traced function
+  // @param phase begin, end or instant
+  void push(TracePoint point, TracePhase phase)
+  {
+    CriticalSection critical_section;
+    m_records[m_head & (DEPTH - 1)] = TraceRecord{now(), point, phase};
+    m_head++;
+  }
+
+  // @brief Take the oldest record
+  // @param record The record
+  // @return true if there was a record
+  bool pop(TraceRecord &record)
+  {
+    CriticalSection critical_section;
+    const uint32_t head = m_head;
+    if (head == m_tail)
+    {
+      return false;
+    }
+
+    // records the reader did not take in time have been overwritten
+    if (head - m_tail > DEPTH)
+    {
+      m_dropped += head - m_tail - DEPTH;
+      m_tail = head - DEPTH;
+    }
+    record = m_records[m_tail & (DEPTH - 1)];
+    m_tail++;
+    return true;
+  }
+
+  // @brief The number of records overwritten before they were read
+  uint32_t dropped() const { return m_dropped; }
+
+  // @brief Discard all records
+  void clear()
+  {
+    CriticalSection critical_section;
+    m_tail    = m_head;
+    m_dropped = 0;
+  }
+
+private:
+  std::array<TraceRecord, DEPTH> m_records{};
+
+  // @brief The number of records ever pushed
+  uint32_t m_head{0};
+
+  // @brief The number of records ever read or dropped
+  uint32_t m_tail{0};
+
+  uint32_t m_dropped{0};
+};
+
+// @brief The trace records of all Driver instances
+constinit inline TraceBuffer<SSD1306_TRACE_DEPTH> trace_buffer;
+
+// @brief Record an event
+// @param point The traced function
+// @param phase begin, end or instant
+inline void record(TracePoint point, TracePhase phase) { trace_buffer.push(point, phase); }
+
+  #if defined(USE_RTT)
+// @brief Send all trace records over RTT channel 0, one "timestamp point phase" line per record
+inline void drain_rtt()
+{
+  TraceRecord record;
+  while (trace_buffer.pop(record))
+  {
+    SEGGER_RTT_printf(0, "\n%u %u %u", record.timestamp, static_cast<unsigned>(record.point), static_cast<unsigned>(record.phase));
+  }
+}
+  #endif
+
+#else
+
+inline void enable_clock() {}
+inline void record(TracePoint, TracePhase) {}
+
+#endif
+
+// @brief Records the begin of a traced function, and its end when it goes out of scope.
+// Compiled out unless SSD1306_TRACE is defined.
+class TraceScope
+{
+public:
+  // @param point The traced function
+  explicit TraceScope(TracePoint point)
+      : m_point(point)
+  {
+    record(m_point, TracePhase::begin);
+  }
+  ~TraceScope() { record(m_point, TracePhase::end); }
+
+  TraceScope(const TraceScope &)            = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+  TracePoint m_point;
+};
+
+} // namespace ssd1306::trace
+
+#endif // __SSD1306_TRACE_HPP__
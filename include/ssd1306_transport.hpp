@@ -0,0 +1,418 @@
+// MIT License
+
+// Copyright (c) 2022 Chris Sutton
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// @note See datasheet
+// https://cdn-shop.adafruit.com/datasheets/SSD1306.pdf
+
+#ifndef __SSD1306_TRANSPORT_HPP__
+#define __SSD1306_TRANSPORT_HPP__
+
+#include <ssd1306_device.hpp>
+#include <timer_manager.hpp>
+
+#ifndef X86_UNIT_TESTING_ONLY
+  #pragma GCC diagnostic push
+  #pragma GCC diagnostic ignored "-Wvolatile"
+  #include <stm32g0xx_ll_i2c.h>
+  #pragma GCC diagnostic pop
+#else
+  #include <vector>
+  // the I2C ISR and ICR bits of stm32g0xx.h polled by I2cTransport, unless the mock defines them
+  #if !defined(I2C_ISR_TXE)
+    #define I2C_ISR_TXE (1U << 0)
+    #define I2C_ISR_TXIS (1U << 1)
+    #define I2C_ISR_NACKF (1U << 4)
+    #define I2C_ISR_STOPF (1U << 5)
+    #define I2C_ICR_NACKCF (1U << 4)
+    #define I2C_ICR_STOPCF (1U << 5)
+  #endif
+#endif
+
+namespace ssd1306
+{
+
+// Transport policies for Driver. Each one is a plain class with the same members, so Driver calls
+// them directly and the byte loops are inlined:
+//  - spi_capable: the SPI peripheral is available for the DMA and interrupt driven modes, see Driver::SPIDMA
+//  - begin(): enable the peripheral
+//  - hardware_reset(): pulse the reset pin of the IC, if there is one
+//  - send_commands(): send command bytes in one transaction
+//  - send_data(): send GDDRAM bytes in one transaction
+// Optionally, record_commands(), record_data() and record_frame() are given all the bus traffic, see RecordingTransport
+
+// @brief 4-wire SPI with a DC pin. Supports all Driver::SPIDMA modes.
+// @tparam DEVICE_ISR_ENUM The interrupt type enum of the MCU, see stm32_interrupt_managers
+template <typename DEVICE_ISR_ENUM>
+class SpiTransport
+{
+public:
+  static constexpr bool spi_capable{true};
+
+  // @brief Construct a new SpiTransport object
+  // @param serial_interface The SPI peripheral, DC and reset pins, and interrupts
+  SpiTransport(const DriverSerialInterface<DEVICE_ISR_ENUM> &serial_interface)
+      : m_serial_interface(serial_interface)
+  {
+  }
+
+  // @brief The SPI peripheral and pins, for the DMA and interrupt driven modes
+  DriverSerialInterface<DEVICE_ISR_ENUM> &serial_interface() { return m_serial_interface; }
+
+#if defined(SSD1306_BUS_STATISTICS)
+  // @brief Count the TXE and BSY waits
+  // @param counters The counters of the Driver
+  void attach_counters(BusCounters *counters) { m_counters = counters; }
+#endif
+
+  // @brief Wait for room in the TXFIFO
+  // @return true if success, false if timeout
+  bool wait_for_txe()
+  {
+#if defined(SSD1306_BUS_STATISTICS)
+    if (m_counters != nullptr)
+    {
+      m_counters->txe_waits++;
+    }
+#endif
+    return stm32::spi_ref::wait_for_txe_flag(m_serial_interface.get_spi_handle());
+  }
+
+  // @brief Wait for the last byte to be shifted out
+  // @return true if success, false if timeout
+  bool wait_for_bsy()
+  {
+#if defined(SSD1306_BUS_STATISTICS)
+    if (m_counters != nullptr)
+    {
+      m_counters->bsy_waits++;
+    }
+#endif
+    return stm32::spi_ref::wait_for_bsy_flag(m_serial_interface.get_spi_handle());
+  }
+
+  // @brief Enable the SPI peripheral
+  void begin() { stm32::spi_ref::enable_spi(m_serial_interface.get_spi_handle()); }
+
+  // @brief Pulse the reset pin of the IC
+  void hardware_reset()
+  {
+#if not defined(X86_UNIT_TESTING_ONLY)
+    LL_GPIO_ResetOutputPin(&m_serial_interface.get_reset_port(), m_serial_interface.get_reset_pin());
+    stm32::delay_millisecond(10);
+    LL_GPIO_SetOutputPin(&m_serial_interface.get_reset_port(), m_serial_interface.get_reset_pin());
+    stm32::delay_millisecond(10);
+#endif
+  }
+
+  // @brief Send a sequence of command bytes in one burst.
+  // DC is set low once for the whole sequence and the bus is only checked for busy after the last byte,
+  // instead of once per byte.
+  // @param cmd_bytes The command bytes, including any command arguments
+  // @param count The number of command bytes
+  // @return true if success, false if error
+  bool send_commands(const uint8_t *cmd_bytes, std::size_t count)
+  {
+    SPI_TypeDef &spi_handle = m_serial_interface.get_spi_handle();
+
+    // a previous data transfer must finish before DC is changed
+    if (!wait_for_bsy())
+    {
+      return false;
+    }
+
+#if not defined(X86_UNIT_TESTING_ONLY)
+    // set cmd mode/low signal
+    LL_GPIO_ResetOutputPin(&m_serial_interface.get_dc_port(), m_serial_interface.get_dc_pin());
+#endif
+
+    // the commands are queued in the TXFIFO back to back
+    for (const uint8_t cmd_byte : std::span<const uint8_t>(cmd_bytes, count))
+    {
+      if (!wait_for_txe())
+      {
+        return false;
+      }
+      stm32::spi_ref::send_byte(spi_handle, cmd_byte);
+    }
+
+    // the last command must be latched before DC is changed again
+    return wait_for_bsy();
+  }
+
+  // @brief Send GDDRAM bytes in one burst.
+  // DC is set once, the TXFIFO is kept full with two data frames per 16-bit write, and BSY is only checked at the end.
+  // @param data The first byte to send
+  // @param length The number of bytes to send
+  // @return true if success, false if error
+  bool send_data(const uint8_t *data, std::size_t length)
+  {
+    SPI_TypeDef &spi_handle = m_serial_interface.get_spi_handle();
+
+// the preceding commands have been latched by send_commands(), so data mode can be set up front
+#ifndef X86_UNIT_TESTING_ONLY
+    LL_GPIO_SetOutputPin(&m_serial_interface.get_dc_port(), m_serial_interface.get_dc_pin());
+#endif
+
+    // TXE is set while the TXFIFO is at most half full, which always leaves room for a 16-bit write
+    std::size_t idx{0};
+    for (; idx + 1 < length; idx += 2)
+    {
+      if (!wait_for_txe())
+      {
+#if defined(USE_RTT)
+        SEGGER_RTT_printf(0, "\nsend_data(): Tx buffer is full.");
+#endif
+        return false;
+      }
+      send_packed_bytes(spi_handle, data[idx], data[idx + 1]);
+    }
+
+    // an odd byte at the end is sent as a single data frame
+    if (idx < length)
+    {
+      if (!wait_for_txe())
+      {
+        return false;
+      }
+      stm32::spi_ref::send_byte(spi_handle, data[idx]);
+    }
+
+    // the last data frame must be shifted out before DC is changed again
+    if (!wait_for_bsy())
+    {
+#if defined(USE_RTT)
+      SEGGER_RTT_printf(0, "\nsend_data(): SPI bus is busy.");
+#endif
+      return false;
+    }
+    return true;
+  }
+
+  // @brief Queue two bytes with a single 16-bit write to DR. With an 8-bit data size
+  // the SPI packs them into two data frames, sending the low byte first. See RM0444 35.5.9.
+  // @param spi_handle The SPI peripheral
+  // @param first The byte sent first
+  // @param second The byte sent second
+  static void send_packed_bytes(SPI_TypeDef &spi_handle, uint8_t first, uint8_t second)
+  {
+    *reinterpret_cast<volatile uint16_t *>(&spi_handle.DR) = static_cast<uint16_t>(first | (second << 8));
+  }
+
+private:
+  // @brief The SPI peripheral, DC and reset pins, and interrupts
+  DriverSerialInterface<DEVICE_ISR_ENUM> m_serial_interface;
+
+#if defined(SSD1306_BUS_STATISTICS)
+  // @brief The counters of the Driver, if attached
+  BusCounters *m_counters{nullptr};
+#endif
+};
+
+// @brief I2C. Every transaction starts with a control byte: 0x00 for commands, 0x40 for GDDRAM data,
+// so a whole page is written in a single transaction. See section 8.1.5 of datasheet.
+// Only Driver::SPIDMA::disabled is supported.
+class I2cTransport
+{
+public:
+  static constexpr bool spi_capable{false};
+
+  // @brief Construct a new I2cTransport object
+  // @param i2c_handle The I2C peripheral e.g. I2C1, configured for the bus speed
+  // @param address The 7-bit slave address, 0x3C or 0x3D depending on the SA0 pin
+  I2cTransport(I2C_TypeDef *i2c_handle, uint8_t address = 0x3C)
+      : m_i2c_handle(*i2c_handle),
+        m_address(address)
+  {
+  }
+
+  // @brief Enable the I2C peripheral
+  void begin()
+  {
+#if not defined(X86_UNIT_TESTING_ONLY)
+    LL_I2C_Enable(&m_i2c_handle);
+#endif
+  }
+
+  // @brief The I2C modules have no reset pin, the IC resets at power up
+  void hardware_reset() {}
+
+  // @brief Send command bytes in one transaction, after a 0x00 control byte
+  // @param cmd_bytes The command bytes, including any command arguments
+  // @param count The number of command bytes
+  // @return true if success, false if NACK or timeout
+  bool send_commands(const uint8_t *cmd_bytes, std::size_t count) { return write(m_command_control, cmd_bytes, count); }
+
+  // @brief Send GDDRAM bytes in one transaction per m_max_payload bytes, after a 0x40 control byte
+  // @param data The first byte to send
+  // @param length The number of bytes to send
+  // @return true if success, false if NACK or timeout
+  bool send_data(const uint8_t *data, std::size_t length)
+  {
+    for (std::size_t offset = 0; offset < length; offset += m_max_payload)
+    {
+      if (!write(m_data_control, data + offset, std::min(length - offset, m_max_payload)))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+private:
+  // @brief The I2C peripheral
+  I2C_TypeDef &m_i2c_handle;
+
+  // @brief The 7-bit slave address
+  uint8_t m_address;
+
+  // @brief Control byte for a stream of command bytes, Co = 0 and D/C# = 0
+  static constexpr uint8_t m_command_control{0x00};
+
+  // @brief Control byte for a stream of GDDRAM bytes, Co = 0 and D/C# = 1
+  static constexpr uint8_t m_data_control{0x40};
+
+  // @brief NBYTES is 8 bits, less the control byte
+  static constexpr std::size_t m_max_payload{254};
+
+  // @brief Polls of a flag before giving up on the slave
+  static constexpr uint32_t m_timeout_polls{100000};
+
+  // @brief Write a control byte and a payload in one transaction, with automatic STOP
+  // @param control The control byte
+  // @param bytes The payload
+  // @param count The number of payload bytes, not more than m_max_payload
+  // @return true if success, false if NACK or timeout
+  bool write(uint8_t control, const uint8_t *bytes, std::size_t count)
+  {
+    // a stale STOPF would end the wait for this transaction's STOP before it happened
+    if (m_i2c_handle.ISR & (I2C_ISR_NACKF | I2C_ISR_STOPF))
+    {
+      m_i2c_handle.ICR = I2C_ICR_NACKCF | I2C_ICR_STOPCF;
+    }
+#if not defined(X86_UNIT_TESTING_ONLY)
+    LL_I2C_HandleTransfer(&m_i2c_handle, m_address << 1, LL_I2C_ADDRSLAVE_7BIT, count + 1, LL_I2C_MODE_AUTOEND, LL_I2C_GENERATE_START_WRITE);
+#endif
+    if (!transmit(control))
+    {
+      return false;
+    }
+    for (const uint8_t byte : std::span<const uint8_t>(bytes, count))
+    {
+      if (!transmit(byte))
+      {
+        return false;
+      }
+    }
+
+    uint32_t polls{m_timeout_polls};
+    while (!(m_i2c_handle.ISR & I2C_ISR_STOPF))
+    {
+      if (m_i2c_handle.ISR & I2C_ISR_NACKF)
+      {
+        return abort_transfer();
+      }
+      if (--polls == 0)
+      {
+        return false;
+      }
+    }
+    // the last byte was not acknowledged
+    if (m_i2c_handle.ISR & I2C_ISR_NACKF)
+    {
+      return abort_transfer();
+    }
+    m_i2c_handle.ICR = I2C_ICR_STOPCF;
+    return true;
+  }
+
+  // @brief Write one byte when the transmit register is empty
+  // @param byte The byte
+  // @return true if success, false if NACK or timeout
+  bool transmit(uint8_t byte)
+  {
+    uint32_t polls{m_timeout_polls};
+    while (!(m_i2c_handle.ISR & I2C_ISR_TXIS))
+    {
+      if (m_i2c_handle.ISR & I2C_ISR_NACKF)
+      {
+        return abort_transfer();
+      }
+      if (--polls == 0)
+      {
+        return false;
+      }
+    }
+    m_i2c_handle.TXDR = byte;
+    return true;
+  }
+
+  // @brief Leave the peripheral ready for the next transaction after a NACK: wait for the automatic STOP that
+  // follows it, clear STOPF and NACKF, and flush the byte left in TXDR. See RM0444 32.4.8.
+  // @return false, the transaction failed
+  bool abort_transfer()
+  {
+    uint32_t polls{m_timeout_polls};
+    while (!(m_i2c_handle.ISR & I2C_ISR_STOPF) && --polls != 0)
+    {
+    }
+    m_i2c_handle.ICR = I2C_ICR_NACKCF | I2C_ICR_STOPCF;
+    m_i2c_handle.ISR = m_i2c_handle.ISR | I2C_ISR_TXE;
+    return false;
+  }
+};
+
+#if defined(X86_UNIT_TESTING_ONLY)
+// @brief Host only: records the bytes instead of sending them
+class MockTransport
+{
+public:
+  static constexpr bool spi_capable{false};
+
+  void begin() {}
+  void hardware_reset() {}
+
+  bool send_commands(const uint8_t *cmd_bytes, std::size_t count)
+  {
+    commands.insert(commands.end(), cmd_bytes, cmd_bytes + count);
+    transactions++;
+    return true;
+  }
+
+  bool send_data(const uint8_t *data_bytes, std::size_t length)
+  {
+    data.insert(data.end(), data_bytes, data_bytes + length);
+    transactions++;
+    return true;
+  }
+
+  // @brief every command byte sent
+  std::vector<uint8_t> commands;
+  // @brief every data byte sent
+  std::vector<uint8_t> data;
+  // @brief the number of send_commands() and send_data() calls
+  std::size_t transactions{0};
+};
+#endif
+
+} // namespace ssd1306
+
+#endif // __SSD1306_TRANSPORT_HPP__
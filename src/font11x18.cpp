@@ -49,15 +49,9 @@ namespace ssd1306
 // - - - - - - - - - - - x x x x x	0x0000  ROW #16
 // - - - - - - - - - - - x x x x x	0x0000  ROW #17
 
-// @brief only 11 MSB of each halfword are used. 1 bit per col.
-template <> uint8_t const Font11x18::m_width{11};
-
-// @brief 18 rows of two bytes (half-words)
-template <> uint8_t const Font11x18::m_height{font11x18_height};
-
 // @brief The font data, top to bottom.
 template <>
-std::array<uint16_t, Font11x18::m_height * char_map_size> Font11x18::data{
+constexpr std::array<uint16_t, Font11x18::m_height * char_map_size> Font11x18::data{
     // clang-format off
 //  ROW #0  ROW #1  ROW #2  ROW #3  ROW #4  ROW #5  ROW #6  ROW #7  ROW #8  ROW #9  ROW#10  ROW#11  ROW#12  ROW#13  ROW#14  ROW#15  ROW#16  ROW#17
     0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,   // sp
@@ -157,4 +151,13 @@ std::array<uint16_t, Font11x18::m_height * char_map_size> Font11x18::data{
     0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x3880, 0x7F80, 0x4700, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,   // ~
 };
 // clang-format on
+
+// @brief The font data packed into columns at compile time. This is the only copy used for rendering.
+template <>
+constexpr std::array<uint8_t, Font11x18Packed::m_glyph_size * Font11x18Packed::m_glyph_count> Font11x18Packed::data{Font11x18Packed::pack(Font11x18::data)};
+
+// @brief The inked columns of each glyph, measured at compile time. Only linked when the proportional font is used.
+template <>
+constexpr std::array<GlyphMetrics, Font11x18Proportional::m_glyph_count> Font11x18Proportional::m_glyphs{Font11x18Proportional::measure(Font11x18::data)};
+
 } // namespace ssd1306
@@ -57,15 +57,9 @@ namespace ssd1306
 // - - - - - - - o o o o o - - - - 	0x01F0  ROW #24
 // - - o o o o o o o o o o o o o o 	0x3FFF  ROW #25
 
-// @brief only 16 MSB of each halfword are used. 1 bit per col.
-template <> uint8_t const Font16x26::m_width{16};
-
-// @brief 26 rows of two bytes (half-words)
-template <> const uint8_t Font16x26::m_height{font16x26_height};
-
 // @brief The font data, top to bottom.
 template <>
-std::array<uint16_t, Font16x26::m_height * char_map_size> Font16x26::data{
+constexpr std::array<uint16_t, Font16x26::m_height * char_map_size> Font16x26::data{
     // clang-format off
 //  ROW #0  ROW #1  ROW #2  ROW #3  ROW #4  ROW #5  ROW #6  ROW #7  ROW #8  ROW #9  ROW#10  ROW#11  ROW#12  ROW#13  ROW#14  ROW#15  ROW#16  ROW#17  ROW#18  ROW#19  ROW#20  ROW#21  ROW#22  ROW#23  ROW#24  ROW#25  
     0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,  // Ascii = [ ]
@@ -165,4 +159,13 @@ std::array<uint16_t, Font16x26::m_height * char_map_size> Font16x26::data{
     0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x3F07, 0x7FC7, 0x73E7, 0xF1FF, 0xF07E, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,  // Ascii = [~]
 };
 // clang-format on
+
+// @brief The font data packed into columns at compile time. This is the only copy used for rendering.
+template <>
+constexpr std::array<uint8_t, Font16x26Packed::m_glyph_size * Font16x26Packed::m_glyph_count> Font16x26Packed::data{Font16x26Packed::pack(Font16x26::data)};
+
+// @brief The inked columns of each glyph, measured at compile time. Only linked when the proportional font is used.
+template <>
+constexpr std::array<GlyphMetrics, Font16x26Proportional::m_glyph_count> Font16x26Proportional::m_glyphs{Font16x26Proportional::measure(Font16x26::data)};
+
 } // namespace ssd1306
@@ -36,15 +36,9 @@ namespace ssd1306
 // - - o - - x x x x x x x x x x x	0x2000  ROW #3
 // - o o o - x x x x x x x x x x x	0x7000  ROW #4
 
-// @brief only 3 MSB of each halfword are used. 1 bit per col.
-template <> uint8_t const Font5x5::m_width{5};
-
-// @brief 5 rows of two bytes (half-words)
-template <> uint8_t const Font5x5::m_height{font5x5_height};
-
 // @brief The font data, top to bottom.
 template <>
-std::array<uint16_t, Font5x5::m_height * char_map_size> Font5x5::data{
+constexpr std::array<uint16_t, Font5x5::m_height * char_map_size> Font5x5::data{
     // clang-format off
 //  ROW #0  ROW #1  ROW #2  ROW #3  ROW #4
     0x0000, 0x0000, 0x0000, 0x0000, 0x0000,  // sp
@@ -145,4 +139,12 @@ std::array<uint16_t, Font5x5::m_height * char_map_size> Font5x5::data{
 };
 // clang-format on
 
+// @brief The font data packed into columns at compile time. This is the only copy used for rendering.
+template <>
+constexpr std::array<uint8_t, Font5x5Packed::m_glyph_size * Font5x5Packed::m_glyph_count> Font5x5Packed::data{Font5x5Packed::pack(Font5x5::data)};
+
+// @brief The inked columns of each glyph, measured at compile time. Only linked when the proportional font is used.
+template <>
+constexpr std::array<GlyphMetrics, Font5x5Proportional::m_glyph_count> Font5x5Proportional::m_glyphs{Font5x5Proportional::measure(Font5x5::data)};
+
 } // namespace ssd1306
@@ -40,15 +40,9 @@ namespace ssd1306
 // - - o - - x x x x x x x x x x x	0x2000  ROW #5
 // o o o o o x x x x x x x x x x x	0xFF00  ROW #6
 
-// @brief only 5 MSB of each halfword are used. 1 bit per col.
-template <> uint8_t const Font5x7::m_width{5};
-
-// @brief 7 rows of two bytes (half-words)
-template <> uint8_t const Font5x7::m_height{font5x7_height};
-
 // @brief The font data, top to bottom.
 template <>
-std::array<uint16_t, Font5x7::m_height * char_map_size> Font5x7::data{
+constexpr std::array<uint16_t, Font5x7::m_height * char_map_size> Font5x7::data{
     // clang-format off
     //  ROW #0  ROW #1  ROW #2  ROW #3  ROW #4  ROW #5  ROW #6
     0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, // sp
@@ -149,4 +143,12 @@ std::array<uint16_t, Font5x7::m_height * char_map_size> Font5x7::data{
 };
 // clang-format on
 
+// @brief The font data packed into columns at compile time. This is the only copy used for rendering.
+template <>
+constexpr std::array<uint8_t, Font5x7Packed::m_glyph_size * Font5x7Packed::m_glyph_count> Font5x7Packed::data{Font5x7Packed::pack(Font5x7::data)};
+
+// @brief The inked columns of each glyph, measured at compile time. Only linked when the proportional font is used.
+template <>
+constexpr std::array<GlyphMetrics, Font5x7Proportional::m_glyph_count> Font5x7Proportional::m_glyphs{Font5x7Proportional::measure(Font5x7::data)};
+
 } // namespace ssd1306
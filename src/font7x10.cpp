@@ -41,15 +41,9 @@ namespace ssd1306
 // - - - - - - - x x x x x x x x x	0x0000  ROW #8
 // - - - - - - - x x x x x x x x x	0x0000  ROW #9
 
-// @brief only 7 MSB of each halfword are used. 1 bit per col.
-template <> uint8_t const Font7x10::m_width{7};
-
-// @brief 10 rows of two bytes (half-words)
-template <> uint8_t const Font7x10::m_height{font7x10_height};
-
 // @brief The font data, top to bottom.
 template <>
-std::array<uint16_t, Font7x10::m_height * char_map_size> Font7x10::data{
+constexpr std::array<uint16_t, Font7x10::m_height * char_map_size> Font7x10::data{
     // clang-format off
 //  ROW #0  ROW #1  ROW #2  ROW #3  ROW #4  ROW #5  ROW #6  ROW #7  ROW #8  ROW #9
     0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,  // sp
@@ -149,4 +143,13 @@ std::array<uint16_t, Font7x10::m_height * char_map_size> Font7x10::data{
     0x0000, 0x0000, 0x0000, 0x7400, 0x4C00, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,  // ~
 };
 // clang-format on
+
+// @brief The font data packed into columns at compile time. This is the only copy used for rendering.
+template <>
+constexpr std::array<uint8_t, Font7x10Packed::m_glyph_size * Font7x10Packed::m_glyph_count> Font7x10Packed::data{Font7x10Packed::pack(Font7x10::data)};
+
+// @brief The inked columns of each glyph, measured at compile time. Only linked when the proportional font is used.
+template <>
+constexpr std::array<GlyphMetrics, Font7x10Proportional::m_glyph_count> Font7x10Proportional::m_glyphs{Font7x10Proportional::measure(Font7x10::data)};
+
 } // namespace ssd1306
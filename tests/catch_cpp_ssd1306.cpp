@@ -25,7 +25,37 @@
 #include <iostream>
 #include <mock.hpp>
 #include <ssd1306.hpp>
+#include <memory>
+#include <ssd1306_emulator.hpp>
+#include <ssd1306_emulator_spi.hpp>
 #include <ssd1306_tester.hpp>
+#include <type_traits>
+
+// @brief A sparse 3x3 test font with only three glyphs
+struct SparseTestCharacterSet
+{
+  static constexpr std::array<char, 3> character_map{ '+', '-', '|' };
+  static constexpr std::array<uint8_t, 128> glyph_index{ ssd1306::make_glyph_index (character_map) };
+};
+
+template <> struct ssd1306::FontTraits<9> : SparseTestCharacterSet
+{
+  static constexpr uint8_t width{ 3 };
+  static constexpr uint8_t height{ 3 };
+};
+
+using FontSparse3x3 = ssd1306::Font<9>;
+
+// clang-format off
+template <> constexpr std::array<uint16_t, 9> FontSparse3x3::data{
+  0x4000, 0xE000, 0x4000, // '+'
+  0x0000, 0xE000, 0x0000, // '-'
+  0x4000, 0x4000, 0x4000, // '|'
+};
+// clang-format on
+template <> constexpr std::array<uint8_t, ssd1306::FontPacked<9>::m_glyph_size * 3> ssd1306::FontPacked<9>::data{
+  ssd1306::FontPacked<9>::pack (FontSparse3x3::data)
+};
 
 TEST_CASE ("Test Fonts", "[ssd1306_fonts]")
 {
@@ -40,9 +70,1344 @@ TEST_CASE ("Test Fonts", "[ssd1306_fonts]")
     ssd1306_spi_interface, ssd1306::Driver<STM32G0_ISR>::SPIDMA::enabled
   };
   ssd1306::Font5x7 f5x7;
-  std::cout << sizeof (f5x7);
   noarch::containers::StaticString<20> m_display_line1;
-  REQUIRE (true);
+
+  // fonts are stateless handles, all font data is static const
+  REQUIRE (std::is_empty_v<ssd1306::Font5x7>);
+  REQUIRE (std::is_empty_v<ssd1306::Font16x26>);
+  REQUIRE (sizeof (f5x7) == 1);
+  REQUIRE (f5x7.size () == ssd1306::font5x7_height * ssd1306::char_map_size);
+  REQUIRE (ssd1306::Font5x7::character_map[33] == 'A');
+}
+
+// @brief check every pixel of every glyph in the packed copy against the row-major font data
+template <std::size_t FONT_SIZE>
+void require_packed_font_matches (const ssd1306::Font<FONT_SIZE> &font)
+{
+  using FontPackedType = ssd1306::FontPacked<FONT_SIZE>;
+  REQUIRE (FontPackedType::m_width == font.width ());
+  REQUIRE (FontPackedType::m_height == font.height ());
+  std::size_t mismatches{ 0 };
+  for (std::size_t glyph_idx = 0; glyph_idx < ssd1306::char_map_size; glyph_idx++)
+  {
+    for (uint8_t row = 0; row < font.height (); row++)
+    {
+      uint32_t bit_line{ 0 };
+      font.get_pixel (glyph_idx * font.height () + row, bit_line);
+      for (uint8_t col = 0; col < font.width (); col++)
+      {
+        const bool expected = (bit_line << col) & 0x8000;
+        const bool actual = (FontPackedType::column (glyph_idx, col) >> row) & 1U;
+        mismatches += (expected != actual) ? 1 : 0;
+      }
+    }
+  }
+  REQUIRE (mismatches == 0);
+}
+
+TEST_CASE ("Packed fonts", "[ssd1306_fonts]")
+{
+  ssd1306::Font5x5 f5x5;
+  ssd1306::Font5x7 f5x7;
+  ssd1306::Font7x10 f7x10;
+  ssd1306::Font11x18 f11x18;
+  ssd1306::Font16x26 f16x26;
+  require_packed_font_matches (f5x5);
+  require_packed_font_matches (f5x7);
+  require_packed_font_matches (f7x10);
+  require_packed_font_matches (f11x18);
+  require_packed_font_matches (f16x26);
+
+  // decoded columns never contain bits of the next column
+  REQUIRE (ssd1306::Font7x10Packed::column (33, 0) < (1U << 10));
+
+  // glyphs are sized to the real font width
+  REQUIRE (ssd1306::Font5x5Packed::m_glyph_size == 4);
+  REQUIRE (ssd1306::Font5x7Packed::m_glyph_size == 5);
+  REQUIRE (ssd1306::Font7x10Packed::m_glyph_size == 9);
+  REQUIRE (ssd1306::Font11x18Packed::m_glyph_size == 25);
+  REQUIRE (ssd1306::Font16x26Packed::m_glyph_size == 52);
+  REQUIRE (ssd1306::Font11x18Packed::data.size () == 25 * ssd1306::char_map_size);
+
+  // the metrics header describes the table
+  constexpr ssd1306::FontMetrics metrics = ssd1306::Font7x10Packed::m_metrics;
+  REQUIRE (metrics.width == 7);
+  REQUIRE (metrics.height == 10);
+  REQUIRE (metrics.first_char == ' ');
+  REQUIRE (metrics.glyph_count == ssd1306::char_map_size);
+  REQUIRE (metrics.glyph_size == 9);
+}
+
+TEST_CASE ("Dirty page tracking", "[ssd1306_dirty]")
+{
+  ssd1306::DriverSerialInterface<STM32G0_ISR> ssd1306_spi_interface (
+      SPI1, std::make_pair (GPIOA, GPIO_BSRR_BS0), // PA0 - DC
+      std::make_pair (GPIOA, GPIO_BSRR_BS3),       // PA3 - Reset
+      STM32G0_ISR::dma1_ch2);
+
+  ssd1306::Driver<STM32G0_ISR> d{
+    ssd1306_spi_interface, ssd1306::Driver<STM32G0_ISR>::SPIDMA::disabled
+  };
+
+  // the power on sequence flushes the whole buffer
+  REQUIRE (d.power_on_sequence ());
+  for (uint8_t page = 0; page < d.m_page_count; page++)
+  {
+    REQUIRE_FALSE (d.is_dirty (page));
+  }
+
+  SECTION ("draw_pixel marks a single column")
+  {
+    d.draw_pixel (10, 20, ssd1306::Colour::White);
+    REQUIRE (d.is_dirty (2));
+    REQUIRE (d.dirty_span (2).first == 10);
+    REQUIRE (d.dirty_span (2).last == 10);
+    REQUIRE_FALSE (d.is_dirty (1));
+    REQUIRE_FALSE (d.is_dirty (3));
+
+    // the span grows to cover both pixels
+    d.draw_pixel (3, 23, ssd1306::Colour::Black);
+    REQUIRE (d.dirty_span (2).first == 3);
+    REQUIRE (d.dirty_span (2).last == 10);
+  }
+
+  SECTION ("fill marks every page")
+  {
+    d.fill (ssd1306::Colour::White);
+    for (uint8_t page = 0; page < d.m_page_count; page++)
+    {
+      REQUIRE (d.is_dirty (page));
+      REQUIRE (d.dirty_span (page).first == 0);
+      REQUIRE (d.dirty_span (page).last == d.m_page_width - 1);
+    }
+    d.clear_dirty ();
+    REQUIRE_FALSE (d.is_dirty (0));
+  }
+}
+
+TEST_CASE ("Glyph rendering", "[ssd1306_glyph]")
+{
+  ssd1306::DriverSerialInterface<STM32G0_ISR> ssd1306_spi_interface (
+      SPI1, std::make_pair (GPIOA, GPIO_BSRR_BS0), // PA0 - DC
+      std::make_pair (GPIOA, GPIO_BSRR_BS3),       // PA3 - Reset
+      STM32G0_ISR::dma1_ch2);
+
+  ssd1306::Driver<STM32G0_ISR> d{
+    ssd1306_spi_interface, ssd1306::Driver<STM32G0_ISR>::SPIDMA::disabled
+  };
+  REQUIRE (d.power_on_sequence ());
+
+  ssd1306::Font5x7 font;
+  noarch::containers::StaticString<1> msg;
+  msg.array ()[0] = '1';
+
+  // Font5x7 '1' as GDDRAM column bytes, LSB is the top row
+  const std::array<uint8_t, 5> glyph{ 0x44, 0x42, 0x7F, 0x40, 0x40 };
+
+  SECTION ("page aligned")
+  {
+    REQUIRE (d.write (msg, font, 0, 0, ssd1306::Colour::Black, ssd1306::Colour::White, false, false) == ssd1306::ErrorStatus::OK);
+    for (uint8_t col = 0; col < glyph.size (); col++)
+    {
+      REQUIRE (d.m_buffer[col] == glyph[col]);
+      REQUIRE (d.m_buffer[d.m_page_width + col] == 0x00);
+    }
+    REQUIRE (d.m_buffer[glyph.size ()] == 0x00);
+    REQUIRE (d.m_currentx == 5);
+    REQUIRE (d.dirty_span (0).first == 0);
+    REQUIRE (d.dirty_span (0).last == 4);
+    REQUIRE_FALSE (d.is_dirty (1));
+  }
+
+  SECTION ("straddling two pages keeps the surrounding pixels")
+  {
+    d.fill (ssd1306::Colour::White);
+    REQUIRE (d.write (msg, font, 0, 3, ssd1306::Colour::Black, ssd1306::Colour::White, false, false) == ssd1306::ErrorStatus::OK);
+    for (uint8_t col = 0; col < glyph.size (); col++)
+    {
+      const uint16_t shifted = glyph[col] << 3;
+      REQUIRE (d.m_buffer[col] == (0x07 | (shifted & 0xF8)));
+      REQUIRE (d.m_buffer[d.m_page_width + col] == (0xFC | (shifted >> 8)));
+    }
+  }
+
+  SECTION ("black on white with padding")
+  {
+    REQUIRE (d.write (msg, font, 10, 8, ssd1306::Colour::White, ssd1306::Colour::Black, true, false) == ssd1306::ErrorStatus::OK);
+    // the leading padding column is always black
+    REQUIRE (d.m_buffer[d.m_page_width + 10] == 0x00);
+    for (uint8_t col = 0; col < glyph.size (); col++)
+    {
+      REQUIRE (d.m_buffer[d.m_page_width + 11 + col] == (~glyph[col] & 0x7F));
+    }
+    REQUIRE (d.m_currentx == 17);
+    REQUIRE (d.dirty_span (1).first == 10);
+    REQUIRE (d.dirty_span (1).last == 15);
+  }
+
+  SECTION ("glyph that does not fit is skipped")
+  {
+    REQUIRE (d.write (msg, font, 124, 60, ssd1306::Colour::Black, ssd1306::Colour::White, false, false) == ssd1306::ErrorStatus::OK);
+    REQUIRE (d.m_currentx == 124);
+    REQUIRE_FALSE (d.is_dirty (7));
+  }
+}
+
+TEST_CASE ("Proportional fonts", "[ssd1306_glyph]")
+{
+  ssd1306::DriverSerialInterface<STM32G0_ISR> ssd1306_spi_interface (
+      SPI1, std::make_pair (GPIOA, GPIO_BSRR_BS0), // PA0 - DC
+      std::make_pair (GPIOA, GPIO_BSRR_BS3),       // PA3 - Reset
+      STM32G0_ISR::dma1_ch2);
+
+  ssd1306::Driver<STM32G0_ISR> d{
+    ssd1306_spi_interface, ssd1306::Driver<STM32G0_ISR>::SPIDMA::disabled
+  };
+  REQUIRE (d.power_on_sequence ());
+
+  noarch::containers::StaticString<2> msg;
+  msg.array ()[0] = '.';
+  msg.array ()[1] = '.';
+
+  SECTION ("glyph metrics")
+  {
+    // Font5x7 '.' is a single pixel in column 2
+    REQUIRE (ssd1306::Font5x7Proportional::glyph_width ('.' - 32) == 1);
+    REQUIRE (ssd1306::Font5x7Proportional::glyph_advance ('.' - 32) == 2);
+    REQUIRE (ssd1306::Font5x7Proportional::m_glyphs['.' - 32].offset == 2);
+    REQUIRE (ssd1306::Font5x7Proportional::column ('.' - 32, 0) == 0x40);
+    // '1' uses the full width
+    REQUIRE (ssd1306::Font5x7Proportional::glyph_width ('1' - 32) == 5);
+    // blank glyphs are half the fixed width
+    REQUIRE (ssd1306::Font16x26Proportional::glyph_width (0) == 8);
+    REQUIRE (ssd1306::Font5x7Proportional::height () == 7);
+  }
+
+  SECTION ("narrow glyphs take less space")
+  {
+    ssd1306::Font5x7Proportional font;
+    REQUIRE (d.write (msg, font, 0, 0, ssd1306::Colour::Black, ssd1306::Colour::White, false, false) == ssd1306::ErrorStatus::OK);
+    REQUIRE (d.m_buffer[0] == 0x40);
+    REQUIRE (d.m_buffer[1] == 0x00);
+    REQUIRE (d.m_buffer[2] == 0x40);
+    REQUIRE (d.m_buffer[3] == 0x00);
+    REQUIRE (d.m_currentx == 4);
+    REQUIRE (d.dirty_span (0).last == 3);
+  }
+
+  SECTION ("kerning pairs move the next glyph")
+  {
+    static constexpr std::array<ssd1306::KerningPair, 2> kerning{ {
+        { '.', '.', -1 },
+        { 'A', 'V', -1 },
+    } };
+    ssd1306::Font5x7Proportional font{ kerning };
+    REQUIRE (font.kerning ('.', '.') == -1);
+    REQUIRE (font.kerning ('.', 'A') == 0);
+
+    // the spacing column of the first '.' is shared with the second
+    d.fill (ssd1306::Colour::Black);
+    REQUIRE (d.write (msg, font, 0, 0, ssd1306::Colour::Black, ssd1306::Colour::White, false, false) == ssd1306::ErrorStatus::OK);
+    REQUIRE (d.m_buffer[0] == 0x40);
+    REQUIRE (d.m_buffer[1] == 0x40);
+    REQUIRE (d.m_buffer[2] == 0x00);
+    REQUIRE (d.m_currentx == 3);
+
+    // padding disables kerning
+    REQUIRE (d.write (msg, font, 0, 8, ssd1306::Colour::Black, ssd1306::Colour::White, true, false) == ssd1306::ErrorStatus::OK);
+    REQUIRE (d.m_currentx == 8);
+  }
+}
+
+TEST_CASE ("Panel geometry", "[ssd1306_geometry]")
+{
+  ssd1306::DriverSerialInterface<STM32G0_ISR> ssd1306_spi_interface (
+      SPI1, std::make_pair (GPIOA, GPIO_BSRR_BS0), // PA0 - DC
+      std::make_pair (GPIOA, GPIO_BSRR_BS3),       // PA3 - Reset
+      STM32G0_ISR::dma1_ch2);
+
+  noarch::containers::StaticString<1> msg;
+  msg.array ()[0] = '1';
+  ssd1306::Font5x7 font;
+
+  SECTION ("128x32")
+  {
+    using Driver128x32 = ssd1306::Driver<STM32G0_ISR, ssd1306::Geometry128x32>;
+    Driver128x32 d{ ssd1306_spi_interface, Driver128x32::SPIDMA::disabled };
+    REQUIRE (d.power_on_sequence ());
+    REQUIRE (d.m_buffer.size () == 512);
+    REQUIRE (d.m_page_count == 4);
+    REQUIRE (ssd1306::Geometry128x32::mux_ratio == 0x1F);
+    REQUIRE (ssd1306::Geometry128x32::com_pin_cfg == 0x02);
+
+    REQUIRE_FALSE (d.set_cursor (0, 32));
+    REQUIRE (d.write (msg, font, 0, 24, ssd1306::Colour::Black, ssd1306::Colour::White, false, false) == ssd1306::ErrorStatus::OK);
+    REQUIRE (d.m_buffer[3 * d.m_page_width] == 0x44);
+    REQUIRE (d.is_dirty (3));
+
+    // the last page is too short for a 7 row glyph starting on row 26
+    REQUIRE (d.write (msg, font, 10, 26, ssd1306::Colour::Black, ssd1306::Colour::White, false, false) == ssd1306::ErrorStatus::OK);
+    REQUIRE (d.m_currentx == 10);
+  }
+
+  SECTION ("64x48")
+  {
+    using Driver64x48 = ssd1306::Driver<STM32G0_ISR, ssd1306::Geometry64x48>;
+    Driver64x48 d{ ssd1306_spi_interface, Driver64x48::SPIDMA::disabled };
+    REQUIRE (d.power_on_sequence ());
+    REQUIRE (d.m_buffer.size () == 384);
+    REQUIRE (d.m_page_count == 6);
+    REQUIRE (ssd1306::Geometry64x48::column_offset == 32);
+
+    d.fill (ssd1306::Colour::White);
+    REQUIRE (d.dirty_span (5).last == 63);
+    REQUIRE_FALSE (d.set_cursor (64, 0));
+    REQUIRE (d.write (msg, font, 60, 0, ssd1306::Colour::Black, ssd1306::Colour::White, false, false) == ssd1306::ErrorStatus::OK);
+    REQUIRE (d.m_currentx == 60);
+  }
+
+  SECTION ("72x40")
+  {
+    using Driver72x40 = ssd1306::Driver<STM32G0_ISR, ssd1306::Geometry72x40>;
+    Driver72x40 d{ ssd1306_spi_interface, Driver72x40::SPIDMA::enabled };
+    REQUIRE (d.power_on_sequence ());
+    REQUIRE (d.m_buffer.size () == 360);
+    REQUIRE (ssd1306::Geometry72x40::mux_ratio == 0x27);
+  }
+}
+
+TEST_CASE ("Command batching", "[ssd1306_commands]")
+{
+  ssd1306::DriverSerialInterface<STM32G0_ISR> ssd1306_spi_interface (
+      SPI1, std::make_pair (GPIOA, GPIO_BSRR_BS0), // PA0 - DC
+      std::make_pair (GPIOA, GPIO_BSRR_BS3),       // PA3 - Reset
+      STM32G0_ISR::dma1_ch2);
+
+  using Driver72x40 = ssd1306::Driver<STM32G0_ISR, ssd1306::Geometry72x40>;
+  Driver72x40 d{ ssd1306_spi_interface, Driver72x40::SPIDMA::disabled };
+
+  // the init tables are generated for the panel
+  REQUIRE (Driver72x40::m_init_commands.front () == 0xAE);
+  REQUIRE (Driver72x40::m_init_commands[8] == 0xA8);
+  REQUIRE (Driver72x40::m_init_commands[9] == 0x27);
+  REQUIRE (Driver72x40::m_init_commands[13] == 0x12);
+  REQUIRE (ssd1306::Driver<STM32G0_ISR, ssd1306::Geometry128x32>::m_init_commands[13] == 0x02);
+  REQUIRE (Driver72x40::m_horiz_addr_commands == std::array<uint8_t, 8>{ 0x20, 0x00, 0x21, 28, 99, 0x22, 0x00, 0x04 });
+  REQUIRE (Driver72x40::m_page_addr_commands == std::array<uint8_t, 5>{ 0x20, 0x02, 0xB0, 0x0C, 0x11 });
+
+  // every byte of the burst is written to the data register
+  REQUIRE (d.send_commands (std::array<uint8_t, 2>{ 0x81, 0x7F }));
+  REQUIRE (SPI1->DR == 0x7F);
+  REQUIRE (d.power_on_sequence ());
+}
+
+// @brief counts the completion callbacks of the "DMA frame transfer" test
+void count_transfers (void *context) { (*static_cast<int *> (context))++; }
+
+// @brief the driver and callback count of chain_transfer()
+struct ChainedTransfer
+{
+  ssd1306::Driver<STM32G0_ISR> *driver;
+  int transfers;
+  bool started;
+};
+
+// @brief starts the next frame transfer from the first completion callback
+void chain_transfer (void *context)
+{
+  ChainedTransfer *chain = static_cast<ChainedTransfer *> (context);
+  chain->transfers++;
+  if (chain->transfers == 1)
+  {
+    chain->started = chain->driver->is_transfer_complete () && chain->driver->begin_frame_transfer ();
+  }
+}
+
+TEST_CASE ("DMA frame transfer", "[ssd1306_dma]")
+{
+  ssd1306::DriverSerialInterface<STM32G0_ISR> ssd1306_spi_interface (
+      SPI1, std::make_pair (GPIOA, GPIO_BSRR_BS0), // PA0 - DC
+      std::make_pair (GPIOA, GPIO_BSRR_BS3),       // PA3 - Reset
+      STM32G0_ISR::dma1_ch2);
+
+  ssd1306::Driver<STM32G0_ISR> d{
+    ssd1306_spi_interface, ssd1306::Driver<STM32G0_ISR>::SPIDMA::enabled
+  };
+  int transfers{ 0 };
+  d.set_transfer_complete_callback (count_transfers, &transfers);
+  REQUIRE (d.is_transfer_complete ());
+
+  // the power on sequence sends the cleared frame
+  REQUIRE (d.power_on_sequence ());
+  REQUIRE_FALSE (d.is_transfer_complete ());
+  REQUIRE_FALSE (d.is_dirty (0));
+
+  // only one transfer at a time
+  REQUIRE_FALSE (d.begin_frame_transfer ());
+  noarch::containers::StaticString<1> msg;
+  msg.array ()[0] = '1';
+  ssd1306::Font5x7 font;
+  REQUIRE (d.write (msg, font, 0, 0, ssd1306::Colour::Black, ssd1306::Colour::White, false, true) == ssd1306::ErrorStatus::DMA_BUSY);
+  REQUIRE (d.is_dirty (0));
+
+  // the ISR signals completion
+  d.dma_isr ();
+  REQUIRE (d.is_transfer_complete ());
+  REQUIRE (transfers == 1);
+
+  // the pending change is sent by the next transfer, writes without update don't start one
+  REQUIRE (d.begin_frame_transfer ());
+  REQUIRE_FALSE (d.is_dirty (0));
+  d.dma_isr ();
+  REQUIRE (d.write (msg, font, 0, 0, ssd1306::Colour::Black, ssd1306::Colour::White, false, false) == ssd1306::ErrorStatus::OK);
+  REQUIRE (d.is_transfer_complete ());
+  REQUIRE (transfers == 2);
+
+  // the bus is idle when the callback runs, so it can start the next transfer
+  ChainedTransfer chain{ &d, 0, false };
+  d.set_transfer_complete_callback (chain_transfer, &chain);
+  REQUIRE (d.begin_frame_transfer ());
+  d.dma_isr ();
+  REQUIRE (chain.started);
+  REQUIRE_FALSE (d.is_transfer_complete ());
+  d.dma_isr ();
+  REQUIRE (chain.transfers == 2);
+  REQUIRE (d.is_transfer_complete ());
+
+  // polled mode has no frame transfers
+  ssd1306::Driver<STM32G0_ISR> polled{
+    ssd1306_spi_interface, ssd1306::Driver<STM32G0_ISR>::SPIDMA::disabled
+  };
+  REQUIRE_FALSE (polled.begin_frame_transfer ());
+}
+
+// every member of the multi buffered drivers compiles, update_region() is left out
+template class ssd1306::Driver<STM32G0_ISR, ssd1306::Geometry128x64, 2>;
+template class ssd1306::Driver<STM32G0_ISR, ssd1306::Geometry128x64, 3>;
+
+template <typename DRIVER>
+concept sends_regions = requires (DRIVER &driver) { driver.update_region (0, 0, 0, 0); };
+
+TEST_CASE ("Double buffering", "[ssd1306_dma]")
+{
+  ssd1306::DriverSerialInterface<STM32G0_ISR> ssd1306_spi_interface (
+      SPI1, std::make_pair (GPIOA, GPIO_BSRR_BS0), // PA0 - DC
+      std::make_pair (GPIOA, GPIO_BSRR_BS3),       // PA3 - Reset
+      STM32G0_ISR::dma1_ch2);
+
+  using DoubleBufferedDriver = ssd1306::Driver<STM32G0_ISR, ssd1306::Geometry128x64, 2>;
+  DoubleBufferedDriver d{ ssd1306_spi_interface, DoubleBufferedDriver::SPIDMA::enabled };
+
+  // a copy would draw into the sw buffers of the original
+  using DoubleBufferedCanvas = ssd1306::CommonFunctions<ssd1306::Geometry128x64, 2>;
+  STATIC_REQUIRE_FALSE (std::is_copy_constructible_v<DoubleBufferedCanvas>);
+  STATIC_REQUIRE_FALSE (std::is_move_constructible_v<DoubleBufferedCanvas>);
+  STATIC_REQUIRE_FALSE (std::is_copy_assignable_v<DoubleBufferedCanvas>);
+  STATIC_REQUIRE_FALSE (std::is_move_assignable_v<DoubleBufferedCanvas>);
+  STATIC_REQUIRE_FALSE (sends_regions<DoubleBufferedDriver>);
+  STATIC_REQUIRE (sends_regions<ssd1306::Driver<STM32G0_ISR>>);
+
+  // the streaming modes would send the buffer being drawn into, so the frames are swapped and sent whole instead
+  using TripleBufferedDriver = ssd1306::Driver<STM32G0_ISR, ssd1306::Geometry128x64, 3>;
+  auto paged    = std::make_unique<DoubleBufferedDriver> (ssd1306_spi_interface, DoubleBufferedDriver::SPIDMA::paged);
+  auto streamed = std::make_unique<TripleBufferedDriver> (ssd1306_spi_interface, TripleBufferedDriver::SPIDMA::interrupt);
+  REQUIRE (paged->spi_dma_setting == DoubleBufferedDriver::SPIDMA::enabled);
+  REQUIRE (streamed->spi_dma_setting == TripleBufferedDriver::SPIDMA::enabled);
+  REQUIRE (streamed->power_on_sequence ());
+  REQUIRE (streamed->last_update_plan ().strategy == ssd1306::UpdateStrategy::full_frame);
+  REQUIRE (d.power_on_sequence ());
+  d.dma_isr ();
+
+  noarch::containers::StaticString<1> msg;
+  msg.array ()[0] = '1';
+  ssd1306::Font5x7 font;
+
+  // draw frame 1 and present it
+  const uint8_t *back_before = d.m_buffer.data ();
+  REQUIRE (d.write (msg, font, 0, 0, ssd1306::Colour::Black, ssd1306::Colour::White, false, false) == ssd1306::ErrorStatus::OK);
+  REQUIRE (d.present () == ssd1306::ErrorStatus::OK);
+  REQUIRE_FALSE (d.is_transfer_complete ());
+
+  // the buffers swapped and the new back buffer starts with frame 1
+  REQUIRE (d.m_buffer.data () != back_before);
+  REQUIRE (d.m_buffer[0] == 0x44);
+
+  // frame 2 is drawn while frame 1 is sent, without touching frame 1
+  REQUIRE (d.write (msg, font, 0, 8, ssd1306::Colour::Black, ssd1306::Colour::White, false, false) == ssd1306::ErrorStatus::OK);
+  REQUIRE (back_before[d.m_page_width] == 0x00);
+  REQUIRE (d.present () == ssd1306::ErrorStatus::DMA_BUSY);
+
+  d.dma_isr ();
+  REQUIRE (d.present () == ssd1306::ErrorStatus::OK);
+  REQUIRE (d.m_buffer.data () == back_before);
+  REQUIRE (d.m_buffer[d.m_page_width] == 0x44);
+}
+
+TEST_CASE ("Triple buffering", "[ssd1306_dma]")
+{
+  ssd1306::DriverSerialInterface<STM32G0_ISR> ssd1306_spi_interface (
+      SPI1, std::make_pair (GPIOA, GPIO_BSRR_BS0), // PA0 - DC
+      std::make_pair (GPIOA, GPIO_BSRR_BS3),       // PA3 - Reset
+      STM32G0_ISR::dma1_ch2);
+
+  using TripleBufferedDriver = ssd1306::Driver<STM32G0_ISR, ssd1306::Geometry128x64, 3>;
+  TripleBufferedDriver d{ ssd1306_spi_interface, TripleBufferedDriver::SPIDMA::enabled };
+  int transfers{ 0 };
+  d.set_transfer_complete_callback (count_transfers, &transfers);
+
+  // the power on frame is being sent
+  REQUIRE (d.power_on_sequence ());
+  REQUIRE_FALSE (d.is_transfer_complete ());
+  const uint8_t *power_on_back = d.m_buffer.data ();
+
+  noarch::containers::StaticString<1> msg;
+  msg.array ()[0] = '1';
+  ssd1306::Font5x7 font;
+
+  // presenting never waits for the bus
+  REQUIRE (d.write (msg, font, 0, 0, ssd1306::Colour::Black, ssd1306::Colour::White, false, false) == ssd1306::ErrorStatus::OK);
+  const uint8_t *frame_a = d.m_buffer.data ();
+  REQUIRE (d.present () == ssd1306::ErrorStatus::OK);
+  REQUIRE (d.m_buffer.data () != frame_a);
+  REQUIRE (d.m_buffer[0] == 0x44);
+
+  // a second frame replaces the unsent one, which is recycled as the back buffer
+  REQUIRE (d.write (msg, font, 0, 8, ssd1306::Colour::Black, ssd1306::Colour::White, false, false) == ssd1306::ErrorStatus::OK);
+  const uint8_t *frame_b = d.m_buffer.data ();
+  REQUIRE (d.present () == ssd1306::ErrorStatus::OK);
+  REQUIRE (d.m_buffer.data () == frame_a);
+  REQUIRE (d.m_buffer[d.m_page_width] == 0x44);
+  REQUIRE (power_on_back == frame_a);
+
+  // the ISR goes straight on to the newest frame, the callback waits until the bus is idle
+  d.dma_isr ();
+  REQUIRE (transfers == 0);
+  REQUIRE_FALSE (d.is_transfer_complete ());
+
+  // and stops when there is nothing new
+  d.dma_isr ();
+  REQUIRE (transfers == 1);
+  REQUIRE (d.is_transfer_complete ());
+
+  // presenting while idle starts a transfer of the presented frame
+  REQUIRE (d.present () == ssd1306::ErrorStatus::OK);
+  REQUIRE_FALSE (d.is_transfer_complete ());
+  REQUIRE (d.m_buffer.data () != frame_b);
+  d.dma_isr ();
+  REQUIRE (d.is_transfer_complete ());
+}
+
+TEST_CASE ("Region update", "[ssd1306_dma]")
+{
+  ssd1306::DriverSerialInterface<STM32G0_ISR> ssd1306_spi_interface (
+      SPI1, std::make_pair (GPIOA, GPIO_BSRR_BS0), // PA0 - DC
+      std::make_pair (GPIOA, GPIO_BSRR_BS3),       // PA3 - Reset
+      STM32G0_ISR::dma1_ch2);
+
+  noarch::containers::StaticString<1> msg;
+  msg.array ()[0] = '1';
+  ssd1306::Font5x7 font;
+
+  SECTION ("dma")
+  {
+    ssd1306::Driver<STM32G0_ISR> d{
+      ssd1306_spi_interface, ssd1306::Driver<STM32G0_ISR>::SPIDMA::enabled
+    };
+    int transfers{ 0 };
+    d.set_transfer_complete_callback (count_transfers, &transfers);
+    REQUIRE (d.power_on_sequence ());
+    d.dma_isr ();
+    REQUIRE (transfers == 1);
+
+    REQUIRE (d.update_region (10, 0, 5, 1) == ssd1306::ErrorStatus::PIXEL_OOB);
+    REQUIRE (d.update_region (0, 0, 128, 1) == ssd1306::ErrorStatus::PIXEL_OOB);
+    REQUIRE (d.update_region (0, 0, 10, 8) == ssd1306::ErrorStatus::PIXEL_OOB);
+
+    // a 30x16 field is sent as two chained page transfers
+    REQUIRE (d.write (msg, font, 40, 4, ssd1306::Colour::Black, ssd1306::Colour::White, false, false) == ssd1306::ErrorStatus::OK);
+    REQUIRE (d.update_region (40, 0, 69, 1) == ssd1306::ErrorStatus::OK);
+    REQUIRE (SPI1->DR == 1);
+    REQUIRE_FALSE (d.is_dirty (0));
+    REQUIRE_FALSE (d.is_dirty (1));
+    REQUIRE (d.update_region (40, 0, 69, 1) == ssd1306::ErrorStatus::DMA_BUSY);
+    d.dma_isr ();
+    REQUIRE_FALSE (d.is_transfer_complete ());
+    d.dma_isr ();
+    REQUIRE (d.is_transfer_complete ());
+    REQUIRE (transfers == 2);
+
+    // full width pages are a single transfer
+    REQUIRE (d.update_region (0, 2, 127, 3) == ssd1306::ErrorStatus::OK);
+    d.dma_isr ();
+    REQUIRE (d.is_transfer_complete ());
+
+    // changes outside the rectangle are kept for the next update
+    REQUIRE (d.write (msg, font, 0, 0, ssd1306::Colour::Black, ssd1306::Colour::White, false, false) == ssd1306::ErrorStatus::OK);
+    REQUIRE (d.write (msg, font, 100, 0, ssd1306::Colour::Black, ssd1306::Colour::White, false, false) == ssd1306::ErrorStatus::OK);
+    REQUIRE (d.update_region (0, 0, 9, 0) == ssd1306::ErrorStatus::OK);
+    REQUIRE (d.is_dirty (0));
+    d.dma_isr ();
+
+    // a full frame restores the whole panel window first
+    REQUIRE (d.begin_frame_transfer ());
+    REQUIRE (SPI1->DR == 7);
+  }
+
+  SECTION ("polled")
+  {
+    ssd1306::Driver<STM32G0_ISR> d{
+      ssd1306_spi_interface, ssd1306::Driver<STM32G0_ISR>::SPIDMA::disabled
+    };
+    REQUIRE (d.power_on_sequence ());
+    REQUIRE (d.write (msg, font, 40, 4, ssd1306::Colour::Black, ssd1306::Colour::White, false, false) == ssd1306::ErrorStatus::OK);
+    REQUIRE (d.update_region (40, 0, 69, 1) == ssd1306::ErrorStatus::OK);
+    REQUIRE (SPI1->DR == d.m_buffer[d.m_page_width + 69]);
+    REQUIRE_FALSE (d.is_dirty (0));
+  }
+}
+
+TEST_CASE ("Update planner", "[ssd1306_dma]")
+{
+  ssd1306::DriverSerialInterface<STM32G0_ISR> ssd1306_spi_interface (
+      SPI1, std::make_pair (GPIOA, GPIO_BSRR_BS0), // PA0 - DC
+      std::make_pair (GPIOA, GPIO_BSRR_BS3),       // PA3 - Reset
+      STM32G0_ISR::dma1_ch2);
+
+  ssd1306::Driver<STM32G0_ISR> d{
+    ssd1306_spi_interface, ssd1306::Driver<STM32G0_ISR>::SPIDMA::enabled
+  };
+  REQUIRE (d.power_on_sequence ());
+  REQUIRE (d.last_update_plan ().strategy == ssd1306::UpdateStrategy::full_frame);
+  REQUIRE (d.last_update_plan ().predicted_bytes () == 1024);
+  d.dma_isr ();
+  REQUIRE (d.plan_update ().strategy == ssd1306::UpdateStrategy::none);
+
+  noarch::containers::StaticString<1> msg;
+  msg.array ()[0] = '1';
+  ssd1306::Font5x7 font;
+
+  SECTION ("a small area is sent as a window")
+  {
+    REQUIRE (d.write (msg, font, 40, 4, ssd1306::Colour::Black, ssd1306::Colour::White, false, true) == ssd1306::ErrorStatus::OK);
+    const ssd1306::UpdatePlan &plan = d.last_update_plan ();
+    REQUIRE (plan.strategy == ssd1306::UpdateStrategy::window);
+    REQUIRE (plan.x0 == 40);
+    REQUIRE (plan.x1 == 44);
+    REQUIRE (plan.page0 == 0);
+    REQUIRE (plan.page1 == 1);
+    REQUIRE (plan.predicted_bytes () == 6 + 10);
+    REQUIRE (plan.transfers == 2);
+    REQUIRE_FALSE (d.is_transfer_complete ());
+  }
+
+  SECTION ("scattered areas are sent page by page")
+  {
+    REQUIRE (d.write (msg, font, 0, 0, ssd1306::Colour::Black, ssd1306::Colour::White, false, false) == ssd1306::ErrorStatus::OK);
+    REQUIRE (d.write (msg, font, 120, 56, ssd1306::Colour::Black, ssd1306::Colour::White, false, true) == ssd1306::ErrorStatus::OK);
+    const ssd1306::UpdatePlan &plan = d.last_update_plan ();
+    REQUIRE (plan.strategy == ssd1306::UpdateStrategy::pages);
+    REQUIRE (plan.predicted_bytes () == 2 * (6 + 5));
+    REQUIRE (d.is_transfer_complete ());
+    REQUIRE_FALSE (d.is_dirty (0));
+    REQUIRE_FALSE (d.is_dirty (7));
+    REQUIRE (SPI1->DR == d.m_buffer[7 * d.m_page_width + 124]);
+  }
+
+  SECTION ("large changes are sent as a full frame")
+  {
+    d.fill (ssd1306::Colour::White);
+    REQUIRE (d.plan_update ().strategy == ssd1306::UpdateStrategy::full_frame);
+    REQUIRE (d.plan_update ().predicted_bytes () == 1024);
+  }
+
+  SECTION ("polled mode always sends pages")
+  {
+    ssd1306::Driver<STM32G0_ISR> polled{
+      ssd1306_spi_interface, ssd1306::Driver<STM32G0_ISR>::SPIDMA::disabled
+    };
+    REQUIRE (polled.power_on_sequence ());
+    REQUIRE (polled.last_update_plan ().strategy == ssd1306::UpdateStrategy::pages);
+    // the address pointer is already at page 0 after the power on sequence
+    REQUIRE (polled.last_update_plan ().predicted_bytes () == 128 + 7 * (3 + 128));
+  }
+}
+
+TEST_CASE ("Controller state shadow", "[ssd1306]")
+{
+  ssd1306::DriverSerialInterface<STM32G0_ISR> ssd1306_spi_interface (
+      SPI1, std::make_pair (GPIOA, GPIO_BSRR_BS0), // PA0 - DC
+      std::make_pair (GPIOA, GPIO_BSRR_BS3),       // PA3 - Reset
+      STM32G0_ISR::dma1_ch2);
+
+  noarch::containers::StaticString<1> msg;
+  msg.array ()[0] = '1';
+  ssd1306::Font5x7 font;
+
+  SECTION ("register settings")
+  {
+    ssd1306::Driver<STM32G0_ISR> d{
+      ssd1306_spi_interface, ssd1306::Driver<STM32G0_ISR>::SPIDMA::disabled
+    };
+    REQUIRE (d.power_on_sequence ());
+    REQUIRE (d.controller_state ().contrast == 0xFF);
+    REQUIRE (d.controller_state ().display_on);
+
+    // unchanged settings are not sent
+    SPI1->DR = 0;
+    REQUIRE (d.set_contrast (0xFF) == ssd1306::ErrorStatus::OK);
+    REQUIRE (d.set_inverse (false) == ssd1306::ErrorStatus::OK);
+    REQUIRE (d.set_display_on (true) == ssd1306::ErrorStatus::OK);
+    REQUIRE (d.stop_scroll () == ssd1306::ErrorStatus::OK);
+    REQUIRE (SPI1->DR == 0);
+
+    REQUIRE (d.set_contrast (0x40) == ssd1306::ErrorStatus::OK);
+    REQUIRE (SPI1->DR == 0x40);
+    REQUIRE (d.set_inverse (true) == ssd1306::ErrorStatus::OK);
+    REQUIRE (SPI1->DR == 0xA7);
+    REQUIRE (d.set_display_on (false) == ssd1306::ErrorStatus::OK);
+    REQUIRE (SPI1->DR == 0xAE);
+    REQUIRE (d.start_scroll (true, 0, 7, 0) == ssd1306::ErrorStatus::OK);
+    REQUIRE (SPI1->DR == 0x2F);
+    REQUIRE (d.controller_state ().scrolling);
+
+    SPI1->DR = 0;
+    REQUIRE (d.start_scroll (true, 0, 7, 0) == ssd1306::ErrorStatus::OK);
+    REQUIRE (SPI1->DR == 0);
+
+    // the shadow holds the interval that was sent
+    REQUIRE (d.start_scroll (true, 0, 7, 0x0B) == ssd1306::ErrorStatus::OK);
+    REQUIRE (d.controller_state ().scroll_interval == 3);
+    SPI1->DR = 0;
+    REQUIRE (d.start_scroll (true, 0, 7, 3) == ssd1306::ErrorStatus::OK);
+    REQUIRE (SPI1->DR == 0);
+
+    // the pages must be on the panel and in order
+    REQUIRE (d.start_scroll (true, 3, 2, 0) == ssd1306::ErrorStatus::PIXEL_OOB);
+    REQUIRE (d.start_scroll (true, 0, 8, 0) == ssd1306::ErrorStatus::PIXEL_OOB);
+    REQUIRE (SPI1->DR == 0);
+
+    // GDDRAM is not written while scrolling, the changes wait for the next update
+    REQUIRE (d.write (msg, font, 40, 12, ssd1306::Colour::Black, ssd1306::Colour::White, false, true) == ssd1306::ErrorStatus::SCROLLING);
+    REQUIRE (d.update_region (0, 0, 7, 0) == ssd1306::ErrorStatus::SCROLLING);
+    REQUIRE (d.present () == ssd1306::ErrorStatus::SCROLLING);
+    REQUIRE (SPI1->DR == 0);
+    REQUIRE (d.is_dirty (1));
+    REQUIRE (d.stop_scroll () == ssd1306::ErrorStatus::OK);
+    REQUIRE (SPI1->DR == 0x2E);
+    REQUIRE (d.is_dirty (0));
+
+    // the power on sequence resets the IC
+    REQUIRE (d.power_on_sequence ());
+    REQUIRE (d.controller_state ().contrast == 0xFF);
+    REQUIRE_FALSE (d.controller_state ().inverse);
+    REQUIRE_FALSE (d.controller_state ().scrolling);
+  }
+
+  SECTION ("page addressing pointer")
+  {
+    ssd1306::Driver<STM32G0_ISR> d{
+      ssd1306_spi_interface, ssd1306::Driver<STM32G0_ISR>::SPIDMA::disabled
+    };
+    REQUIRE (d.power_on_sequence ());
+
+    // the column wraps after the last column, so only the page is known
+    REQUIRE (d.write (msg, font, 0, 8, ssd1306::Colour::Black, ssd1306::Colour::White, false, false) == ssd1306::ErrorStatus::OK);
+    REQUIRE (d.plan_update ().command_bytes == 3);
+    REQUIRE (d.update_region (0, 1, 4, 1) == ssd1306::ErrorStatus::OK);
+    REQUIRE (d.controller_state ().page == 1);
+    REQUIRE (d.controller_state ().column == 5);
+
+    // continuing on the same page from the pointer needs no commands
+    REQUIRE (d.write (msg, font, 5, 8, ssd1306::Colour::Black, ssd1306::Colour::White, false, false) == ssd1306::ErrorStatus::OK);
+    REQUIRE (d.plan_update ().command_bytes == 0);
+    REQUIRE (d.update_region (5, 1, 9, 1) == ssd1306::ErrorStatus::OK);
+    REQUIRE (d.controller_state ().column == 10);
+
+    // same upper nibble, only the lower column command is sent
+    REQUIRE (d.write (msg, font, 2, 8, ssd1306::Colour::Black, ssd1306::Colour::White, false, false) == ssd1306::ErrorStatus::OK);
+    REQUIRE (d.plan_update ().command_bytes == 1);
+  }
+
+  SECTION ("horizontal addressing window")
+  {
+    ssd1306::Driver<STM32G0_ISR> d{
+      ssd1306_spi_interface, ssd1306::Driver<STM32G0_ISR>::SPIDMA::enabled
+    };
+    REQUIRE (d.power_on_sequence ());
+    d.dma_isr ();
+
+    REQUIRE (d.write (msg, font, 40, 4, ssd1306::Colour::Black, ssd1306::Colour::White, false, true) == ssd1306::ErrorStatus::OK);
+    REQUIRE (d.last_update_plan ().command_bytes == 6);
+    REQUIRE (d.set_contrast (0x10) == ssd1306::ErrorStatus::DMA_BUSY);
+    d.dma_isr ();
+    d.dma_isr ();
+
+    // the same window again
+    REQUIRE (d.write (msg, font, 40, 4, ssd1306::Colour::Black, ssd1306::Colour::White, false, true) == ssd1306::ErrorStatus::OK);
+    REQUIRE (d.last_update_plan ().command_bytes == 0);
+    d.dma_isr ();
+    d.dma_isr ();
+
+    // the full frame window must be restored
+    d.fill (ssd1306::Colour::White);
+    REQUIRE (d.plan_update ().command_bytes == 6);
+    REQUIRE (d.set_contrast (0x10) == ssd1306::ErrorStatus::OK);
+  }
+}
+
+TEST_CASE ("Burst transmit", "[ssd1306]")
+{
+  ssd1306::DriverSerialInterface<STM32G0_ISR> ssd1306_spi_interface (
+      SPI1, std::make_pair (GPIOA, GPIO_BSRR_BS0), // PA0 - DC
+      std::make_pair (GPIOA, GPIO_BSRR_BS3),       // PA3 - Reset
+      STM32G0_ISR::dma1_ch2);
+
+  ssd1306::Driver<STM32G0_ISR> d{
+    ssd1306_spi_interface, ssd1306::Driver<STM32G0_ISR>::SPIDMA::disabled
+  };
+  REQUIRE (d.power_on_sequence ());
+  for (uint8_t col = 0; col < d.m_page_width; col++)
+  {
+    d.m_buffer[2 * d.m_page_width + col] = col;
+  }
+
+  SECTION ("pairs of bytes are packed into one 16-bit write")
+  {
+    SPI1->DR = 0;
+    REQUIRE (d.update_region (10, 2, 13, 2) == ssd1306::ErrorStatus::OK);
+    REQUIRE (SPI1->DR == (12 | (13 << 8)));
+  }
+
+  SECTION ("an odd byte at the end is sent alone")
+  {
+    SPI1->DR = 0;
+    REQUIRE (d.update_region (10, 2, 14, 2) == ssd1306::ErrorStatus::OK);
+    REQUIRE (SPI1->DR == 14);
+  }
+}
+
+// @brief the driver, callback count and result of queue_update()
+struct QueuedUpdate
+{
+  ssd1306::Driver<STM32G0_ISR> *driver;
+  int transfers;
+  ssd1306::ErrorStatus result;
+};
+
+// @brief queues an update of the start of page 0 from the first completion callback
+void queue_update (void *context)
+{
+  QueuedUpdate *queued = static_cast<QueuedUpdate *> (context);
+  queued->transfers++;
+  if (queued->transfers == 1)
+  {
+    queued->result = queued->driver->update_region (0, 0, 7, 0);
+  }
+}
+
+TEST_CASE ("Interrupt driven transfer", "[ssd1306]")
+{
+  ssd1306::DriverSerialInterface<STM32G0_ISR> ssd1306_spi_interface (
+      SPI1, std::make_pair (GPIOA, GPIO_BSRR_BS0), // PA0 - DC
+      std::make_pair (GPIOA, GPIO_BSRR_BS3),       // PA3 - Reset
+      STM32G0_ISR::dma1_ch2, STM32G0_ISR::spi1);
+
+  ssd1306::Driver<STM32G0_ISR> d{
+    ssd1306_spi_interface, ssd1306::Driver<STM32G0_ISR>::SPIDMA::interrupt
+  };
+  int transfers{0};
+  d.set_transfer_complete_callback (count_transfers, &transfers);
+
+  // returns as soon as the stream has started
+  REQUIRE (d.power_on_sequence ());
+  REQUIRE_FALSE (d.is_transfer_complete ());
+  REQUIRE (SPI1->CR2 & SPI_CR2_TXEIE);
+  REQUIRE (d.update_region (0, 0, 7, 0) == ssd1306::ErrorStatus::DMA_BUSY);
+  REQUIRE (d.set_contrast (0x10) == ssd1306::ErrorStatus::DMA_BUSY);
+
+  // page 0 needs no commands, each other page needs 3. Each interrupt queues 2 data bytes and
+  // one more moves on to the next page.
+  int interrupts{0};
+  while (!d.is_transfer_complete () && interrupts < 1000)
+  {
+    d.spi_isr ();
+    interrupts++;
+  }
+  REQUIRE (interrupts == (64 + 1) + 7 * (3 + 64 + 1));
+  REQUIRE (transfers == 1);
+  REQUIRE_FALSE (SPI1->CR2 & SPI_CR2_TXEIE);
+
+  noarch::containers::StaticString<1> msg;
+  msg.array ()[0] = '1';
+  ssd1306::Font5x7 font;
+  REQUIRE (d.write (msg, font, 40, 12, ssd1306::Colour::Black, ssd1306::Colour::White, false, true) == ssd1306::ErrorStatus::OK);
+  REQUIRE (d.last_update_plan ().strategy == ssd1306::UpdateStrategy::pages);
+  REQUIRE_FALSE (d.is_dirty (1));
+
+  // 3 commands for page 1 but only the page and lower column for page 2, then the 5 columns of each page
+  interrupts = 0;
+  while (!d.is_transfer_complete () && interrupts < 1000)
+  {
+    d.spi_isr ();
+    interrupts++;
+  }
+  REQUIRE (interrupts == (3 + 3 + 1) + (2 + 3 + 1));
+  REQUIRE (SPI1->DR == d.m_buffer[2 * d.m_page_width + 44]);
+  REQUIRE (transfers == 2);
+
+  // the bus is idle when the callback runs, so it can queue the next update
+  QueuedUpdate queued{ &d, 0, ssd1306::ErrorStatus::DMA_BUSY };
+  d.set_transfer_complete_callback (queue_update, &queued);
+  REQUIRE (d.update_region (0, 1, 3, 1) == ssd1306::ErrorStatus::OK);
+  interrupts = 0;
+  while (!d.is_transfer_complete () && interrupts < 1000)
+  {
+    d.spi_isr ();
+    interrupts++;
+  }
+  REQUIRE (queued.result == ssd1306::ErrorStatus::OK);
+  REQUIRE (queued.transfers == 2);
+}
+
+TEST_CASE ("Paged DMA transfer", "[ssd1306_dma]")
+{
+  ssd1306::DriverSerialInterface<STM32G0_ISR> ssd1306_spi_interface (
+      SPI1, std::make_pair (GPIOA, GPIO_BSRR_BS0), // PA0 - DC
+      std::make_pair (GPIOA, GPIO_BSRR_BS3),       // PA3 - Reset
+      STM32G0_ISR::dma1_ch2);
+
+  ssd1306::Driver<STM32G0_ISR> d{
+    ssd1306_spi_interface, ssd1306::Driver<STM32G0_ISR>::SPIDMA::paged
+  };
+  int transfers{0};
+  d.set_transfer_complete_callback (count_transfers, &transfers);
+
+  // one DMA transfer per page
+  REQUIRE (d.power_on_sequence ());
+  REQUIRE (d.last_update_plan ().strategy == ssd1306::UpdateStrategy::pages);
+  int interrupts{0};
+  while (!d.is_transfer_complete () && interrupts < 100)
+  {
+    d.dma_isr ();
+    interrupts++;
+  }
+  REQUIRE (interrupts == 8);
+  REQUIRE (transfers == 1);
+
+  // the ISR sends the address commands of the next page, leaving out those that would not change anything
+  noarch::containers::StaticString<1> msg;
+  msg.array ()[0] = '1';
+  ssd1306::Font5x7 font;
+  REQUIRE (d.write (msg, font, 40, 12, ssd1306::Colour::Black, ssd1306::Colour::White, false, true) == ssd1306::ErrorStatus::OK);
+  REQUIRE (SPI1->DR == 0x12);
+  REQUIRE (d.update_region (0, 0, 7, 0) == ssd1306::ErrorStatus::DMA_BUSY);
+  d.dma_isr ();
+  REQUIRE (SPI1->DR == 0x08);
+  REQUIRE (d.controller_state ().page == 2);
+  REQUIRE_FALSE (d.is_transfer_complete ());
+  d.dma_isr ();
+  REQUIRE (d.is_transfer_complete ());
+  REQUIRE (transfers == 2);
+}
+
+TEST_CASE ("Transport policy", "[ssd1306]")
+{
+  noarch::containers::StaticString<1> msg;
+  msg.array ()[0] = '1';
+  ssd1306::Font5x7 font;
+
+  SECTION ("mock")
+  {
+    using MockDriver = ssd1306::Driver<STM32G0_ISR, ssd1306::Geometry128x64, 1, ssd1306::MockTransport>;
+    MockDriver d{ ssd1306::MockTransport{}, MockDriver::SPIDMA::enabled };
+    REQUIRE (d.spi_dma_setting == MockDriver::SPIDMA::disabled);
+    REQUIRE (d.power_on_sequence ());
+
+    // init, addressing mode and display on, then 8 pages with the address commands of pages 1-7
+    const ssd1306::MockTransport &bus = d.transport ();
+    REQUIRE (bus.transactions == 3 + 8 + 7);
+    REQUIRE (bus.data.size () == d.m_buffer_size);
+    REQUIRE (std::equal (d.m_init_commands.begin (), d.m_init_commands.end (), bus.commands.begin ()));
+
+    REQUIRE (d.write (msg, font, 40, 12, ssd1306::Colour::Black, ssd1306::Colour::White, false, true) == ssd1306::ErrorStatus::OK);
+    REQUIRE (bus.data.size () == d.m_buffer_size + 2 * 5);
+    REQUIRE (bus.data.back () == d.m_buffer[2 * d.m_page_width + 44]);
+  }
+
+  SECTION ("i2c")
+  {
+    using I2cDriver = ssd1306::Driver<STM32G0_ISR, ssd1306::Geometry128x64, 1, ssd1306::I2cTransport>;
+    I2cDriver d{ ssd1306::I2cTransport{ I2C1 }, I2cDriver::SPIDMA::disabled };
+
+    // the mocked peripheral acknowledges every byte and every transaction has ended
+    I2C1->ISR = I2C_ISR_TXIS | I2C_ISR_STOPF;
+    REQUIRE (d.power_on_sequence ());
+    REQUIRE (d.write (msg, font, 40, 12, ssd1306::Colour::Black, ssd1306::Colour::White, false, true) == ssd1306::ErrorStatus::OK);
+    REQUIRE (I2C1->TXDR == d.m_buffer[2 * d.m_page_width + 44]);
+
+    // a NACK waits for the automatic STOP, clears both flags and flushes TXDR
+    ssd1306::I2cTransport bus{ I2C1 };
+    const std::array<uint8_t, 2> contrast{ 0x81, 0x40 };
+    I2C1->ISR = I2C_ISR_NACKF | I2C_ISR_STOPF;
+    I2C1->ICR = 0;
+    REQUIRE_FALSE (bus.send_commands (contrast.data (), contrast.size ()));
+    REQUIRE (I2C1->ICR == (I2C_ICR_NACKCF | I2C_ICR_STOPCF));
+    REQUIRE (I2C1->ISR & I2C_ISR_TXE);
+
+    // so does a NACK of the last byte, which only shows with the STOP
+    I2C1->ISR = I2C_ISR_TXIS | I2C_ISR_NACKF | I2C_ISR_STOPF;
+    I2C1->ICR = 0;
+    REQUIRE_FALSE (bus.send_commands (contrast.data (), contrast.size ()));
+    REQUIRE (I2C1->ICR == (I2C_ICR_NACKCF | I2C_ICR_STOPCF));
+    REQUIRE (I2C1->ISR & I2C_ISR_TXE);
+
+    // the next transaction is sent whole
+    I2C1->ISR = I2C_ISR_TXIS | I2C_ISR_STOPF;
+    I2C1->TXDR = 0;
+    REQUIRE (bus.send_commands (contrast.data (), contrast.size ()));
+    REQUIRE (I2C1->TXDR == 0x40);
+    REQUIRE (I2C1->ICR == I2C_ICR_STOPCF);
+  }
+}
+
+// @brief check the emulated GDDRAM against the sw buffer of a panel
+template <typename DRIVER>
+bool gddram_matches (const ssd1306::Emulator &emulator, DRIVER &d, uint8_t column_offset = 0)
+{
+  for (uint8_t page = 0; page < d.m_page_count; page++)
+  {
+    for (uint8_t col = 0; col < d.m_page_width; col++)
+    {
+      if (emulator.gddram[page][column_offset + col] != d.m_buffer[page * d.m_page_width + col])
+      {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+TEST_CASE ("Emulator", "[ssd1306]")
+{
+  ssd1306::Emulator emulator;
+  noarch::containers::StaticString<1> msg;
+  msg.array ()[0] = '1';
+  ssd1306::Font5x7 font;
+
+  SECTION ("128x64")
+  {
+    using EmulatedDriver = ssd1306::Driver<STM32G0_ISR, ssd1306::Geometry128x64, 1, ssd1306::EmulatorTransport>;
+    EmulatedDriver d{ ssd1306::EmulatorTransport{ emulator }, EmulatedDriver::SPIDMA::disabled };
+    emulator.gddram[3].fill (0xAA);
+    REQUIRE (d.power_on_sequence ());
+    REQUIRE (emulator.unknown_commands == 0);
+    REQUIRE (emulator.display_on);
+    REQUIRE (emulator.contrast == 0xFF);
+    REQUIRE (emulator.mux_ratio == 63);
+    REQUIRE (emulator.addressing_mode == ssd1306::Emulator::AddressingMode::page);
+    REQUIRE (gddram_matches (emulator, d));
+
+    // the planner predicts the bytes that reach the controller
+    for (uint8_t y : { 0, 12, 13, 40 })
+    {
+      const std::size_t command_bytes = emulator.command_bytes;
+      const std::size_t data_bytes    = emulator.data_bytes;
+      REQUIRE (d.write (msg, font, 3 * y, y, ssd1306::Colour::Black, ssd1306::Colour::White, false, true) == ssd1306::ErrorStatus::OK);
+      REQUIRE (emulator.command_bytes - command_bytes == d.last_update_plan ().command_bytes);
+      REQUIRE (emulator.data_bytes - data_bytes == d.last_update_plan ().data_bytes);
+      REQUIRE (gddram_matches (emulator, d));
+    }
+    REQUIRE (d.update_region (0, 2, 127, 5) == ssd1306::ErrorStatus::OK);
+    REQUIRE (gddram_matches (emulator, d));
+
+    // unchanged settings never reach the controller
+    const std::size_t command_bytes = emulator.command_bytes;
+    REQUIRE (d.set_contrast (0xFF) == ssd1306::ErrorStatus::OK);
+    REQUIRE (emulator.command_bytes == command_bytes);
+    REQUIRE (d.set_contrast (0x20) == ssd1306::ErrorStatus::OK);
+    REQUIRE (d.set_inverse (true) == ssd1306::ErrorStatus::OK);
+    REQUIRE (d.start_scroll (false, 1, 6, 3) == ssd1306::ErrorStatus::OK);
+    REQUIRE (emulator.contrast == 0x20);
+    REQUIRE (emulator.inverse);
+    REQUIRE (emulator.scrolling);
+    REQUIRE (emulator.scroll_command == 0x27);
+    REQUIRE (emulator.scroll_start_page == 1);
+    REQUIRE (emulator.scroll_end_page == 6);
+    REQUIRE (emulator.scroll_interval == 3);
+    REQUIRE (d.write (msg, font, 90, 40, ssd1306::Colour::Black, ssd1306::Colour::White, false, true) == ssd1306::ErrorStatus::SCROLLING);
+    REQUIRE (d.stop_scroll () == ssd1306::ErrorStatus::OK);
+    REQUIRE_FALSE (emulator.scrolling);
+    REQUIRE (emulator.writes_while_scrolling == 0);
+
+    // stopping the scroll rewrites GDDRAM, including what was drawn while scrolling
+    REQUIRE (d.present () == ssd1306::ErrorStatus::OK);
+    REQUIRE (gddram_matches (emulator, d));
+    REQUIRE (emulator.unknown_commands == 0);
+  }
+
+  SECTION ("128x64 dma and interrupt transfers")
+  {
+    ssd1306::DriverSerialInterface<STM32G0_ISR> ssd1306_spi_interface (
+        SPI1, std::make_pair (GPIOA, GPIO_BSRR_BS0), // PA0 - DC
+        std::make_pair (GPIOA, GPIO_BSRR_BS3),       // PA3 - Reset
+        STM32G0_ISR::dma1_ch2, STM32G0_ISR::spi1);
+    using EmulatedDriver = ssd1306::Driver<STM32G0_ISR, ssd1306::Geometry128x64, 1, ssd1306::EmulatorSpiTransport<STM32G0_ISR>>;
+
+    for (const auto mode : { EmulatedDriver::SPIDMA::enabled, EmulatedDriver::SPIDMA::interrupt, EmulatedDriver::SPIDMA::paged })
+    {
+      auto spi_emulator = std::make_unique<ssd1306::Emulator> ();
+      auto d = std::make_unique<EmulatedDriver> (ssd1306::EmulatorSpiTransport<STM32G0_ISR>{ ssd1306_spi_interface, *spi_emulator }, mode);
+      auto finish_transfer = [&] {
+        for (int interrupts = 0; !d->is_transfer_complete () && interrupts < 1000; interrupts++)
+        {
+          if (mode == EmulatedDriver::SPIDMA::interrupt)
+          {
+            d->spi_isr ();
+          }
+          else
+          {
+            d->dma_isr ();
+          }
+        }
+        return d->is_transfer_complete ();
+      };
+
+      spi_emulator->gddram[3].fill (0xAA);
+      REQUIRE (d->power_on_sequence ());
+      REQUIRE (finish_transfer ());
+      REQUIRE (gddram_matches (*spi_emulator, *d));
+
+      // the planner predicts the bytes that reach the controller, with DMA small areas are sent as windows
+      for (uint8_t y : { 0, 12, 13, 40 })
+      {
+        const std::size_t command_bytes = spi_emulator->command_bytes;
+        const std::size_t data_bytes    = spi_emulator->data_bytes;
+        REQUIRE (d->write (msg, font, 3 * y, y, ssd1306::Colour::Black, ssd1306::Colour::White, false, true) == ssd1306::ErrorStatus::OK);
+        REQUIRE (finish_transfer ());
+        REQUIRE (d->last_update_plan ().strategy == (mode == EmulatedDriver::SPIDMA::enabled ? ssd1306::UpdateStrategy::window : ssd1306::UpdateStrategy::pages));
+        REQUIRE (spi_emulator->command_bytes - command_bytes == d->last_update_plan ().command_bytes);
+        REQUIRE (spi_emulator->data_bytes - data_bytes == d->last_update_plan ().data_bytes);
+        REQUIRE (gddram_matches (*spi_emulator, *d));
+      }
+
+      // windows and page spans of update_region()
+      REQUIRE (d->write (msg, font, 40, 4, ssd1306::Colour::Black, ssd1306::Colour::White, false, false) == ssd1306::ErrorStatus::OK);
+      REQUIRE (d->update_region (40, 0, 69, 1) == ssd1306::ErrorStatus::OK);
+      REQUIRE (finish_transfer ());
+      REQUIRE (gddram_matches (*spi_emulator, *d));
+      d->fill (ssd1306::Colour::White);
+      REQUIRE (d->update_region (0, 2, 127, 5) == ssd1306::ErrorStatus::OK);
+      REQUIRE (finish_transfer ());
+      REQUIRE (d->update_region (100, 6, 127, 7) == ssd1306::ErrorStatus::OK);
+      REQUIRE (finish_transfer ());
+      REQUIRE (d->update_region (0, 0, 99, 1) == ssd1306::ErrorStatus::OK);
+      REQUIRE (finish_transfer ());
+      REQUIRE_FALSE (gddram_matches (*spi_emulator, *d));
+
+      // a large change is sent as a full frame, after restoring the whole panel window
+      d->fill (ssd1306::Colour::Black);
+      const std::size_t command_bytes = spi_emulator->command_bytes;
+      const std::size_t data_bytes    = spi_emulator->data_bytes;
+      REQUIRE (d->write (msg, font, 60, 30, ssd1306::Colour::Black, ssd1306::Colour::White, false, true) == ssd1306::ErrorStatus::OK);
+      REQUIRE (finish_transfer ());
+      if (mode == EmulatedDriver::SPIDMA::enabled)
+      {
+        REQUIRE (d->last_update_plan ().strategy == ssd1306::UpdateStrategy::full_frame);
+      }
+      REQUIRE (spi_emulator->command_bytes - command_bytes == d->last_update_plan ().command_bytes);
+      REQUIRE (spi_emulator->data_bytes - data_bytes == d->last_update_plan ().data_bytes);
+      REQUIRE (gddram_matches (*spi_emulator, *d));
+
+      // unchanged settings never reach the controller
+      REQUIRE (d->set_contrast (0x20) == ssd1306::ErrorStatus::OK);
+      const std::size_t settings_bytes = spi_emulator->command_bytes;
+      REQUIRE (d->set_contrast (0x20) == ssd1306::ErrorStatus::OK);
+      REQUIRE (spi_emulator->command_bytes == settings_bytes);
+      REQUIRE (spi_emulator->contrast == 0x20);
+      REQUIRE (spi_emulator->unknown_commands == 0);
+    }
+  }
+
+  SECTION ("72x40")
+  {
+    using EmulatedDriver = ssd1306::Driver<STM32G0_ISR, ssd1306::Geometry72x40, 1, ssd1306::EmulatorTransport>;
+    EmulatedDriver d{ ssd1306::EmulatorTransport{ emulator }, EmulatedDriver::SPIDMA::disabled };
+    REQUIRE (d.power_on_sequence ());
+    REQUIRE (emulator.mux_ratio == 39);
+    REQUIRE (d.start_scroll (true, 0, 5, 0) == ssd1306::ErrorStatus::PIXEL_OOB);
+    REQUIRE (d.write (msg, font, 60, 30, ssd1306::Colour::Black, ssd1306::Colour::White, false, true) == ssd1306::ErrorStatus::OK);
+    REQUIRE (gddram_matches (emulator, d, ssd1306::Geometry72x40::column_offset));
+
+    // the panel is mounted with the segments and COM lines remapped
+    REQUIRE (emulator.segment_remap);
+    REQUIRE (emulator.com_scan_remap);
+    REQUIRE (emulator.pixel (127 - (ssd1306::Geometry72x40::column_offset + 62), 39 - 30) == static_cast<bool> (d.m_buffer[3 * d.m_page_width + 62] & (1 << 6)));
+  }
+}
+
+#if defined(SSD1306_BUS_STATISTICS)
+// @brief a clock that advances 10 ticks every time it is read
+uint32_t fake_clock ()
+{
+  static uint32_t ticks{0};
+  ticks += 10;
+  return ticks;
+}
+
+TEST_CASE ("Bus statistics", "[ssd1306]")
+{
+  ssd1306::DriverSerialInterface<STM32G0_ISR> ssd1306_spi_interface (
+      SPI1, std::make_pair (GPIOA, GPIO_BSRR_BS0), // PA0 - DC
+      std::make_pair (GPIOA, GPIO_BSRR_BS3),       // PA3 - Reset
+      STM32G0_ISR::dma1_ch2);
+
+  noarch::containers::StaticString<1> msg;
+  msg.array ()[0] = '1';
+  ssd1306::Font5x7 font;
+
+  SECTION ("polled")
+  {
+    ssd1306::Driver<STM32G0_ISR> d{
+      ssd1306_spi_interface, ssd1306::Driver<STM32G0_ISR>::SPIDMA::disabled
+    };
+    d.set_statistics_clock (fake_clock);
+    REQUIRE (d.power_on_sequence ());
+
+    // the power on commands are counted in the first frame
+    const ssd1306::BusStatistics &stats = d.bus_statistics ();
+    REQUIRE (stats.frames == 1);
+    REQUIRE (stats.frame.command_bytes == 20 + 5 + 1 + 7 * 3);
+    REQUIRE (stats.frame.data_bytes == d.m_buffer_size);
+    REQUIRE (stats.frame.transfers == 3 + 7 + 8);
+    REQUIRE (stats.frame.dc_toggles == 1 + 7 * 2);
+    REQUIRE (stats.frame.txe_waits == stats.frame.command_bytes + d.m_buffer_size / 2);
+    REQUIRE (stats.frame.bsy_waits == 2 * (3 + 7) + 8);
+    REQUIRE (stats.last_frame_ticks == 10);
+
+    // nothing to send is not a frame
+    REQUIRE (d.write (msg, font, 40, 12, ssd1306::Colour::Black, ssd1306::Colour::White, false, true) == ssd1306::ErrorStatus::OK);
+    REQUIRE (d.update_region (0, 0, 0, 0) == ssd1306::ErrorStatus::OK);
+    REQUIRE (d.present () == ssd1306::ErrorStatus::OK);
+    REQUIRE (stats.frames == 3);
+    REQUIRE (stats.frame.data_bytes == 1);
+    REQUIRE (stats.total.data_bytes == d.m_buffer_size + 2 * 5 + 1);
+    REQUIRE (stats.min_frame_ticks == 10);
+    REQUIRE (stats.max_frame_ticks == 10);
+
+    d.reset_bus_statistics ();
+    REQUIRE (stats.frames == 0);
+  }
+
+  SECTION ("dma")
+  {
+    ssd1306::Driver<STM32G0_ISR> d{
+      ssd1306_spi_interface, ssd1306::Driver<STM32G0_ISR>::SPIDMA::enabled
+    };
+    d.set_statistics_clock (fake_clock);
+    REQUIRE (d.power_on_sequence ());
+
+    // the frame completes in the ISR
+    const ssd1306::BusStatistics &stats = d.bus_statistics ();
+    REQUIRE (stats.frames == 0);
+    fake_clock ();
+    d.dma_isr ();
+    REQUIRE (stats.frames == 1);
+    REQUIRE (stats.frame.data_bytes == d.m_buffer_size);
+    REQUIRE (stats.frame.transfers == 3 + 1);
+    REQUIRE (stats.last_frame_ticks == 20);
+  }
+}
+#endif
+
+// @brief render every glyph of a font and check the buffer against the row-major font data
+template <std::size_t FONT_SIZE>
+void require_font_renders (ssd1306::Driver<STM32G0_ISR> &d, const ssd1306::Font<FONT_SIZE> &font)
+{
+  noarch::containers::StaticString<1> msg;
+  std::size_t mismatches{ 0 };
+  for (std::size_t glyph_idx = 0; glyph_idx < font.character_map.size (); glyph_idx++)
+  {
+    msg.array ()[0] = font.character_map[glyph_idx];
+    if (d.write (msg, font, 0, 0, ssd1306::Colour::Black, ssd1306::Colour::White, false, false) != ssd1306::ErrorStatus::OK)
+    {
+      mismatches++;
+    }
+    for (uint8_t row = 0; row < font.height (); row++)
+    {
+      uint32_t bit_line{ 0 };
+      font.get_pixel (glyph_idx * font.height () + row, bit_line);
+      for (uint8_t col = 0; col < font.width (); col++)
+      {
+        const bool expected = (bit_line << col) & 0x8000;
+        const bool actual = (d.m_buffer[(row / 8) * d.m_page_width + col] >> (row % 8)) & 1U;
+        mismatches += (expected != actual) ? 1 : 0;
+      }
+    }
+  }
+  REQUIRE (mismatches == 0);
+}
+
+TEST_CASE ("Glyph index", "[ssd1306_fonts]")
+{
+  ssd1306::DriverSerialInterface<STM32G0_ISR> ssd1306_spi_interface (
+      SPI1, std::make_pair (GPIOA, GPIO_BSRR_BS0), // PA0 - DC
+      std::make_pair (GPIOA, GPIO_BSRR_BS3),       // PA3 - Reset
+      STM32G0_ISR::dma1_ch2);
+
+  ssd1306::Driver<STM32G0_ISR> d{
+    ssd1306_spi_interface, ssd1306::Driver<STM32G0_ISR>::SPIDMA::disabled
+  };
+  REQUIRE (d.power_on_sequence ());
+
+  SECTION ("character lookup")
+  {
+    REQUIRE (ssd1306::Font5x7::glyph_index (' ') == 0);
+    REQUIRE (ssd1306::Font5x7::glyph_index ('A') == 33);
+    REQUIRE (ssd1306::Font16x26::glyph_index ('~') == 94);
+    REQUIRE (ssd1306::Font5x7Proportional::glyph_index ('A') == 33);
+    REQUIRE (ssd1306::Font5x7::glyph_index ('\n') == ssd1306::no_glyph);
+    REQUIRE (ssd1306::Font5x7::glyph_index (0x7F) == ssd1306::no_glyph);
+    REQUIRE (ssd1306::Font5x7::glyph_index (static_cast<char> (0xC8)) == ssd1306::no_glyph);
+
+    // the last row is the last valid index
+    uint32_t bit_line{ 0 };
+    REQUIRE (ssd1306::Font5x7::get_pixel (ssd1306::Font5x7::size () - 1, bit_line));
+    REQUIRE_FALSE (ssd1306::Font5x7::get_pixel (ssd1306::Font5x7::size (), bit_line));
+  }
+
+  SECTION ("every glyph of every font")
+  {
+    require_font_renders (d, ssd1306::Font5x5{});
+    require_font_renders (d, ssd1306::Font5x7{});
+    require_font_renders (d, ssd1306::Font7x10{});
+    require_font_renders (d, ssd1306::Font11x18{});
+    require_font_renders (d, ssd1306::Font16x26{});
+  }
+
+  SECTION ("sparse character set")
+  {
+    REQUIRE (FontSparse3x3::glyph_index ('+') == 0);
+    REQUIRE (FontSparse3x3::glyph_index ('|') == 2);
+    REQUIRE (FontSparse3x3::glyph_index ('A') == ssd1306::no_glyph);
+    REQUIRE (ssd1306::FontPacked<9>::m_metrics.first_char == '+');
+    REQUIRE (ssd1306::FontPacked<9>::m_metrics.glyph_count == 3);
+    require_font_renders (d, FontSparse3x3{});
+
+    // the string stops at the null byte
+    noarch::containers::StaticString<4> msg;
+    msg.array ().fill ('\0');
+    msg.array ()[0] = '-';
+    msg.array ()[1] = '+';
+    d.fill (ssd1306::Colour::Black);
+    REQUIRE (d.write (msg, FontSparse3x3{}, 0, 0, ssd1306::Colour::Black, ssd1306::Colour::White, false, false) == ssd1306::ErrorStatus::OK);
+    REQUIRE (d.m_buffer[0] == 0x02);
+    REQUIRE (d.m_buffer[4] == 0x07);
+    REQUIRE (d.m_currentx == 6);
+
+    // characters without a glyph are rejected
+    msg.array ()[2] = 'A';
+    REQUIRE (d.write (msg, FontSparse3x3{}, 0, 0, ssd1306::Colour::Black, ssd1306::Colour::White, false, false) == ssd1306::ErrorStatus::PIXEL_OOB);
+  }
 }
 
 // TEST_CASE("Test Fonts", "[ssd1306_fonts]")
@@ -219,14 +1584,14 @@ template uint8_t ssd1306::Font5x5::width();
 template uint8_t ssd1306::Font5x5::height();
 template size_t ssd1306::Font5x5::size();
 enum class DummyInterruptType { usart5, capacity };
-template ssd1306::Driver<DummyInterruptType>::Driver(const DriverSerialInterface<DummyInterruptType> &display_spi_interface, SPIDMA dma_option);
+template ssd1306::Driver<DummyInterruptType>::Driver(const SpiTransport<DummyInterruptType> &transport, SPIDMA dma_option);
 template bool ssd1306::Driver<DummyInterruptType>::power_on_sequence();
 template void ssd1306::Driver<DummyInterruptType>::dma_isr();
 template void ssd1306::Driver<DummyInterruptType>::reset();
 template ssd1306::ErrorStatus ssd1306::Driver<DummyInterruptType>::update_screen();
 template bool ssd1306::Driver<DummyInterruptType>::send_command(uint8_t page_pos_gddram);
-template bool ssd1306::Driver<DummyInterruptType>::send_page_data(uint16_t page_pos_gddram);
-template ssd1306::ErrorStatus ssd1306::Driver<DummyInterruptType>::write(noarch::containers::StaticString<1> &msg, ssd1306::Font5x5 &font, uint8_t x, uint8_t y, Colour bg, Colour fg, bool padding, bool update);
+template bool ssd1306::Driver<DummyInterruptType>::send_page_data(uint16_t page_pos_gddram, uint16_t length);
+template ssd1306::ErrorStatus ssd1306::Driver<DummyInterruptType>::write(noarch::containers::StaticString<1> &msg, const ssd1306::Font5x5 &font, uint8_t x, uint8_t y, Colour bg, Colour fg, bool padding, bool update);
 template ssd1306::DriverSerialInterface<DummyInterruptType>::DriverSerialInterface(SPI_TypeDef *display_spi, std::pair<GPIO_TypeDef*, uint16_t> dc_gpio, std::pair<GPIO_TypeDef*, uint16_t> reset_gpio, DummyInterruptType dma_isr_type);
 template SPI_TypeDef& ssd1306::DriverSerialInterface<DummyInterruptType>::get_spi_handle();
 template GPIO_TypeDef& ssd1306::DriverSerialInterface<DummyInterruptType>::get_dc_port();
@@ -0,0 +1,278 @@
+// MIT License
+
+// Copyright (c) 2022 Chris Sutton
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+// Host micro-benchmarks for the rendering primitives and the update planner.
+// These are hidden from the default test run; run them with: ./build/test_suite "[!benchmark]"
+// Catch2 reports the time per operation. The bytes each scenario puts on the wire are printed
+// after the timings, as counted by the emulated controller or, for buffer-only operations, as
+// predicted for the next update.
+
+#include <catch2/catch_all.hpp>
+#include <cstdio>
+#include <mock.hpp>
+#include <ssd1306.hpp>
+#include <ssd1306_emulator.hpp>
+#include <ssd1306_emulator_spi.hpp>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// @brief Exposes the protected string and character writers of the driver to the benchmarks
+class BenchDriver : public ssd1306::Driver<STM32G0_ISR, ssd1306::Geometry128x64, 1, ssd1306::EmulatorTransport>
+{
+public:
+  using Base = ssd1306::Driver<STM32G0_ISR, ssd1306::Geometry128x64, 1, ssd1306::EmulatorTransport>;
+  using Base::Base;
+  using Base::write_char;
+  using Base::write_string;
+};
+
+// @brief Sends its updates over DMA, so the planner can pick the window and full frame strategies
+using DmaBenchDriver = ssd1306::Driver<STM32G0_ISR, ssd1306::Geometry128x64, 1, ssd1306::EmulatorSpiTransport<STM32G0_ISR>>;
+
+// @brief The bytes a scenario puts on the wire
+struct WireBytes
+{
+  std::string scenario;
+  std::size_t command_bytes;
+  std::size_t data_bytes;
+};
+
+// @brief The bytes on the wire of every scenario of a test case, printed by print_bytes()
+std::vector<WireBytes> wire_bytes;
+
+// @brief Record the bytes a scenario puts on the wire
+// @param scenario
+// @param command_bytes
+// @param data_bytes
+void report_bytes (const std::string &scenario, std::size_t command_bytes, std::size_t data_bytes)
+{
+  wire_bytes.push_back (WireBytes{ scenario, command_bytes, data_bytes });
+}
+
+// @brief Record the bytes the next update will put on the wire, then discard the pending changes
+// @param scenario
+// @param d
+void report_plan (const std::string &scenario, BenchDriver &d)
+{
+  const ssd1306::UpdatePlan plan = d.plan_update ();
+  report_bytes (scenario, plan.command_bytes, plan.data_bytes);
+  d.clear_dirty ();
+}
+
+// @brief Print and clear the recorded bytes on the wire
+void print_bytes ()
+{
+  std::printf ("\n%-28s %8s %8s %8s\n", "scenario", "bytes", "command", "data");
+  for (const WireBytes &entry : wire_bytes)
+  {
+    std::printf ("%-28s %8zu %8zu %8zu\n", entry.scenario.c_str (), entry.command_bytes + entry.data_bytes, entry.command_bytes, entry.data_bytes);
+  }
+  wire_bytes.clear ();
+}
+
+// @brief Benchmark the character and string writers for one font
+// @tparam FONT
+// @param d
+// @param name the font name used in the scenario names
+template <typename FONT>
+void bench_font (BenchDriver &d, const std::string &name)
+{
+  static const FONT font;
+  noarch::containers::StaticString<4> msg;
+  msg.array () = { '0', '4', 'A', 'g' };
+
+  d.clear_dirty ();
+  REQUIRE (d.set_cursor (0, 0));
+  REQUIRE (d.write_char ('A', font, ssd1306::Colour::White, false) == ssd1306::ErrorStatus::OK);
+  report_plan ("write_char " + name, d);
+  BENCHMARK ("write_char " + name)
+  {
+    d.set_cursor (0, 0);
+    return d.write_char ('A', font, ssd1306::Colour::White, false);
+  };
+
+  REQUIRE (d.set_cursor (0, 0));
+  REQUIRE (d.write_string (msg, font, ssd1306::Colour::White, false) == ssd1306::ErrorStatus::OK);
+  report_plan ("write_string " + name, d);
+  BENCHMARK ("write_string " + name)
+  {
+    d.set_cursor (0, 0);
+    return d.write_string (msg, font, ssd1306::Colour::White, false);
+  };
+}
+
+// @brief Benchmark an update over DMA, including the DMA ISRs that chain its transfers
+// @tparam DIRTY
+// @param scenario
+// @param d
+// @param emulator counts the bytes on the wire
+// @param dirty marks the changed area, as drawing would. A glyph is written with the update on top of it.
+// @param strategy the update strategy the planner is expected to pick
+template <typename DIRTY>
+void bench_dma_update (const std::string &scenario, DmaBenchDriver &d, const ssd1306::Emulator &emulator, DIRTY dirty, ssd1306::UpdateStrategy strategy)
+{
+  static const ssd1306::Font7x10 font;
+  noarch::containers::StaticString<1> msg;
+  msg.array () = { '1' };
+  auto update = [&] {
+    dirty ();
+    const ssd1306::ErrorStatus res = d.write (msg, font, 60, 30, ssd1306::Colour::Black, ssd1306::Colour::White, false, true);
+    while (!d.is_transfer_complete ())
+    {
+      d.dma_isr ();
+    }
+    return res;
+  };
+
+  const std::size_t command_bytes = emulator.command_bytes;
+  const std::size_t data_bytes    = emulator.data_bytes;
+  REQUIRE (update () == ssd1306::ErrorStatus::OK);
+  REQUIRE (d.last_update_plan ().strategy == strategy);
+  report_bytes (scenario, emulator.command_bytes - command_bytes, emulator.data_bytes - data_bytes);
+  BENCHMARK (std::string{ scenario }) { return update (); };
+}
+
+} // namespace
+
+TEST_CASE ("Rendering benchmarks", "[!benchmark]")
+{
+  static ssd1306::Emulator emulator;
+  BenchDriver d{ ssd1306::EmulatorTransport{ emulator }, BenchDriver::SPIDMA::disabled };
+  REQUIRE (d.power_on_sequence ());
+  d.clear_dirty ();
+
+  d.draw_pixel (10, 20, ssd1306::Colour::White);
+  report_plan ("draw_pixel", d);
+  uint8_t x{0};
+  BENCHMARK ("draw_pixel")
+  {
+    x = (x + 1) & 0x7F;
+    d.draw_pixel (x, x & 0x3F, ssd1306::Colour::White);
+    return x;
+  };
+
+  d.fill (ssd1306::Colour::Black);
+  report_plan ("fill", d);
+  BENCHMARK ("fill") { d.fill (ssd1306::Colour::Black); };
+
+  bench_font<ssd1306::Font5x5> (d, "Font5x5");
+  bench_font<ssd1306::Font5x7> (d, "Font5x7");
+  bench_font<ssd1306::Font7x10> (d, "Font7x10");
+  bench_font<ssd1306::Font11x18> (d, "Font11x18");
+  bench_font<ssd1306::Font16x26> (d, "Font16x26");
+  print_bytes ();
+}
+
+TEST_CASE ("Update benchmarks", "[!benchmark]")
+{
+  static ssd1306::Emulator emulator;
+  BenchDriver d{ ssd1306::EmulatorTransport{ emulator }, BenchDriver::SPIDMA::disabled };
+  REQUIRE (d.power_on_sequence ());
+  d.clear_dirty ();
+
+  static const ssd1306::Font7x10 font;
+  noarch::containers::StaticString<4> msg;
+  msg.array () = { '1', '2', '3', '4' };
+
+  SECTION ("write")
+  {
+    REQUIRE (d.write (msg, font, 20, 20, ssd1306::Colour::Black, ssd1306::Colour::White, false, false) == ssd1306::ErrorStatus::OK);
+    report_plan ("write", d);
+    BENCHMARK ("write") { return d.write (msg, font, 20, 20, ssd1306::Colour::Black, ssd1306::Colour::White, false, false); };
+
+    d.clear_dirty ();
+    std::size_t command_bytes = emulator.command_bytes;
+    std::size_t data_bytes    = emulator.data_bytes;
+    REQUIRE (d.write (msg, font, 20, 20, ssd1306::Colour::Black, ssd1306::Colour::White, false, true) == ssd1306::ErrorStatus::OK);
+    report_bytes ("write + update", emulator.command_bytes - command_bytes, emulator.data_bytes - data_bytes);
+    BENCHMARK ("write + update") { return d.write (msg, font, 20, 20, ssd1306::Colour::Black, ssd1306::Colour::White, false, true); };
+
+    d.fill (ssd1306::Colour::White);
+    command_bytes = emulator.command_bytes;
+    data_bytes    = emulator.data_bytes;
+    REQUIRE (d.present () == ssd1306::ErrorStatus::OK);
+    report_bytes ("full frame update", emulator.command_bytes - command_bytes, emulator.data_bytes - data_bytes);
+    BENCHMARK ("full frame update")
+    {
+      d.mark_all_dirty ();
+      return d.present ();
+    };
+    print_bytes ();
+  }
+
+  SECTION ("plan_update")
+  {
+    report_plan ("plan_update clean", d);
+    BENCHMARK ("plan_update clean") { return d.plan_update (); };
+
+    REQUIRE (d.write (msg, font, 20, 20, ssd1306::Colour::Black, ssd1306::Colour::White, false, false) == ssd1306::ErrorStatus::OK);
+    const ssd1306::UpdatePlan glyphs = d.plan_update ();
+    BENCHMARK ("plan_update glyphs") { return d.plan_update (); };
+    report_plan ("plan_update glyphs", d);
+    REQUIRE (glyphs.strategy != ssd1306::UpdateStrategy::none);
+
+    for (uint8_t page = 0; page < 8; page += 2)
+    {
+      d.mark_dirty (page, page * 8, page * 8 + 3);
+    }
+    BENCHMARK ("plan_update scattered") { return d.plan_update (); };
+    report_plan ("plan_update scattered", d);
+
+    d.mark_all_dirty ();
+    BENCHMARK ("plan_update full frame") { return d.plan_update (); };
+    report_plan ("plan_update full frame", d);
+    print_bytes ();
+  }
+}
+
+TEST_CASE ("DMA update benchmarks", "[!benchmark]")
+{
+  ssd1306::DriverSerialInterface<STM32G0_ISR> ssd1306_spi_interface (
+      SPI1, std::make_pair (GPIOA, GPIO_BSRR_BS0), // PA0 - DC
+      std::make_pair (GPIOA, GPIO_BSRR_BS3),       // PA3 - Reset
+      STM32G0_ISR::dma1_ch2);
+
+  static ssd1306::Emulator emulator;
+  DmaBenchDriver d{ ssd1306::EmulatorSpiTransport<STM32G0_ISR>{ ssd1306_spi_interface, emulator }, DmaBenchDriver::SPIDMA::enabled };
+  REQUIRE (d.power_on_sequence ());
+  while (!d.is_transfer_complete ())
+  {
+    d.dma_isr ();
+  }
+
+  // one glyph, a quarter of the panel and the whole panel
+  bench_dma_update ("dma small area", d, emulator, [] {}, ssd1306::UpdateStrategy::window);
+  bench_dma_update (
+      "dma medium area", d, emulator,
+      [&d] {
+        for (uint8_t page = 2; page <= 5; page++)
+        {
+          d.mark_dirty (page, 32, 95);
+        }
+      },
+      ssd1306::UpdateStrategy::window);
+  bench_dma_update ("dma full screen", d, emulator, [&d] { d.mark_all_dirty (); }, ssd1306::UpdateStrategy::full_frame);
+  print_bytes ();
+}
@@ -0,0 +1,174 @@
+// MIT License
+
+// Copyright (c) 2022 Chris Sutton
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include <catch2/catch_all.hpp>
+#include <cstdio>
+#include <memory>
+#include <mock.hpp>
+#include <ssd1306.hpp>
+#include <ssd1306_bus_replay.hpp>
+#include <vector>
+
+namespace
+{
+
+// @brief a clock that advances 10 ticks every time it is read
+uint32_t trace_clock ()
+{
+  static uint32_t ticks{0};
+  ticks += 10;
+  return ticks;
+}
+
+} // namespace
+
+TEST_CASE ("Bus trace", "[ssd1306]")
+{
+  noarch::containers::StaticString<2> msg;
+  msg.array ()[0] = '4';
+  msg.array ()[1] = '2';
+  ssd1306::Font5x7 font;
+
+  SECTION ("record and replay")
+  {
+    using Sink           = ssd1306::BusTraceRing<4096>;
+    using Transport      = ssd1306::RecordingTransport<ssd1306::EmulatorTransport, Sink>;
+    using RecordedDriver = ssd1306::Driver<STM32G0_ISR, ssd1306::Geometry128x64, 1, Transport>;
+    auto emulator        = std::make_unique<ssd1306::Emulator> ();
+    auto ring            = std::make_unique<Sink> ();
+    ssd1306::BusRecorder<Sink> recorder{ *ring, trace_clock };
+    RecordedDriver d{ Transport{ ssd1306::EmulatorTransport{ *emulator }, recorder }, RecordedDriver::SPIDMA::disabled };
+
+    REQUIRE (d.power_on_sequence ());
+    REQUIRE (d.write (msg, font, 10, 12, ssd1306::Colour::Black, ssd1306::Colour::White, false, true) == ssd1306::ErrorStatus::OK);
+#if defined(SSD1306_BUS_STATISTICS)
+    const ssd1306::BusCounters last_frame = d.bus_statistics ().frame;
+#endif
+    REQUIRE (d.present () == ssd1306::ErrorStatus::OK);
+    REQUIRE (d.set_contrast (0x40) == ssd1306::ErrorStatus::OK);
+
+    std::vector<uint8_t> trace (ring->size ());
+    REQUIRE (ring->read (trace.data (), trace.size ()) == trace.size ());
+    REQUIRE (ring->dropped () == 0);
+
+    // the replayed controller ends up where the recorded one did
+    auto replayed                     = std::make_unique<ssd1306::Emulator> ();
+    const ssd1306::ReplayReport report = ssd1306::replay (trace, *replayed);
+    REQUIRE (report.valid);
+    REQUIRE (replayed->gddram == emulator->gddram);
+    REQUIRE (replayed->contrast == 0x40);
+    REQUIRE (report.total.command_bytes == emulator->command_bytes);
+    REQUIRE (report.total.data_bytes == emulator->data_bytes);
+
+    // frames match the bus statistics; a present() with nothing to send is not a frame
+    REQUIRE (report.frames.size () == 2);
+    REQUIRE (report.frames[0].data_bytes == d.m_buffer_size);
+#if defined(SSD1306_BUS_STATISTICS)
+    REQUIRE (report.frames[1].command_bytes == last_frame.command_bytes);
+    REQUIRE (report.frames[1].data_bytes == last_frame.data_bytes);
+    REQUIRE (report.frames[1].transfers == last_frame.transfers);
+#endif
+    REQUIRE (report.frames[1].ticks == 10 * report.frames[1].transfers);
+    REQUIRE (report.unfinished.command_bytes == 2);
+    REQUIRE (report.unfinished.data_bytes == 0);
+
+    // a truncated trace is reported
+    trace.pop_back ();
+    REQUIRE_FALSE (ssd1306::replay (trace, *replayed).valid);
+  }
+
+  SECTION ("dma transfers are recorded")
+  {
+    ssd1306::DriverSerialInterface<STM32G0_ISR> ssd1306_spi_interface (
+        SPI1, std::make_pair (GPIOA, GPIO_BSRR_BS0), // PA0 - DC
+        std::make_pair (GPIOA, GPIO_BSRR_BS3),       // PA3 - Reset
+        STM32G0_ISR::dma1_ch2);
+
+    std::FILE *file = std::tmpfile ();
+    REQUIRE (file != nullptr);
+    ssd1306::BusTraceFile sink{ file };
+    ssd1306::BusRecorder<ssd1306::BusTraceFile> recorder{ sink };
+    using Transport      = ssd1306::RecordingTransport<ssd1306::SpiTransport<STM32G0_ISR>, ssd1306::BusTraceFile>;
+    using RecordedDriver = ssd1306::Driver<STM32G0_ISR, ssd1306::Geometry128x64, 1, Transport>;
+    RecordedDriver d{ Transport{ ssd1306_spi_interface, recorder }, RecordedDriver::SPIDMA::enabled };
+
+    REQUIRE (d.power_on_sequence ());
+    d.dma_isr ();
+    REQUIRE (d.write (msg, font, 10, 12, ssd1306::Colour::Black, ssd1306::Colour::White, false, true) == ssd1306::ErrorStatus::OK);
+    while (!d.is_transfer_complete ())
+    {
+      d.dma_isr ();
+    }
+
+    std::vector<uint8_t> trace (static_cast<std::size_t> (std::ftell (file)));
+    std::rewind (file);
+    REQUIRE (std::fread (trace.data (), 1, trace.size (), file) == trace.size ());
+    std::fclose (file);
+
+    auto replayed                     = std::make_unique<ssd1306::Emulator> ();
+    const ssd1306::ReplayReport report = ssd1306::replay (trace, *replayed);
+    REQUIRE (report.valid);
+    REQUIRE (report.frames.size () == 2);
+    REQUIRE (report.frames[0].data_bytes == d.m_buffer_size);
+    REQUIRE (report.frames[1].data_bytes == d.last_update_plan ().data_bytes);
+    REQUIRE (report.total.ticks == 0);
+    for (uint8_t page = 0; page < d.m_page_count; page++)
+    {
+      for (uint8_t col = 0; col < d.m_page_width; col++)
+      {
+        REQUIRE (replayed->gddram[page][col] == d.m_buffer[page * d.m_page_width + col]);
+      }
+    }
+  }
+
+  SECTION ("records that do not fit are dropped whole")
+  {
+    ssd1306::BusTraceRing<64> ring;
+    ssd1306::BusRecorder<ssd1306::BusTraceRing<64>> recorder{ ring };
+    const std::array<uint8_t, 10> commands{ 0xAE, 0xD5, 0x80, 0xA8, 0x3F, 0xD3, 0x00, 0x40, 0x8D, 0x14 };
+    for (std::size_t idx = 0; idx < 6; idx++)
+    {
+      recorder.commands (commands.data (), commands.size ());
+    }
+    recorder.frame ();
+
+    // header and 4 records of 13 bytes, the frame record fits in what is left
+    REQUIRE (ring.dropped () == 2);
+    std::array<uint8_t, 64> trace;
+    const std::size_t length = ring.read (trace.data (), trace.size ());
+    REQUIRE (length == ssd1306::bus_trace_header.size () + 4 * 13 + 2);
+    REQUIRE (ring.size () == 0);
+
+    ssd1306::BusTraceReader reader{ std::span<const uint8_t> (trace.data (), length) };
+    ssd1306::BusTraceRecord record;
+    for (std::size_t idx = 0; idx < 4; idx++)
+    {
+      REQUIRE (reader.next (record));
+      REQUIRE (record.type == ssd1306::BusRecordType::commands);
+      REQUIRE (std::equal (record.bytes.begin (), record.bytes.end (), commands.begin (), commands.end ()));
+    }
+    REQUIRE (reader.next (record));
+    REQUIRE (record.type == ssd1306::BusRecordType::frame);
+    REQUIRE_FALSE (reader.next (record));
+    REQUIRE (reader.valid ());
+  }
+}
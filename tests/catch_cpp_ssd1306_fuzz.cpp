@@ -0,0 +1,390 @@
+// MIT License
+
+// Copyright (c) 2022 Chris Sutton
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+// Differential fuzzing of the glyph renderer. Random strings are written with random fonts, positions, colours and
+// padding over random buffer contents, once by CommonFunctions::write_string() and once by a reference renderer that
+// reads the row-major Font data and sets every pixel with draw_pixel(), and the buffers are compared.
+// The cases are spread over all cores. Every case is generated from the Catch2 seed and its case number, so a
+// failure is reproduced with: ./build/test_suite "[ssd1306_fuzz]" --rng-seed <seed>
+// Set SSD1306_FUZZ_CASES to run more cases, e.g. SSD1306_FUZZ_CASES=10000000
+
+#include <algorithm>
+#include <atomic>
+#include <catch2/catch_all.hpp>
+#include <cstdlib>
+#include <memory>
+#include <mock.hpp>
+#include <random>
+#include <ssd1306.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+// @brief The number of cases run when SSD1306_FUZZ_CASES is not set
+constexpr uint64_t default_fuzz_cases{20000};
+
+// @brief The longest string written by a case
+constexpr std::size_t max_text_length{8};
+
+// @brief Exposes the protected string writer of CommonFunctions
+// @tparam GEOMETRY
+template <typename GEOMETRY>
+class Canvas : public ssd1306::CommonFunctions<GEOMETRY>
+{
+public:
+  using ssd1306::CommonFunctions<GEOMETRY>::write_string;
+};
+
+// @brief Kerning pairs for the proportional fonts. Includes pairs that overlap the previous character.
+constexpr std::array<ssd1306::KerningPair, 6> kerning{ {
+    { 'A', 'V', -2 },
+    { 'V', 'A', -2 },
+    { 'T', 'o', -1 },
+    { 'L', 'T', -3 },
+    { 'r', '.', -1 },
+    { '1', '1', 1 },
+} };
+
+// @brief Characters that appear in the kerning pairs, so strings hit them often
+constexpr std::array<char, 9> kerned_characters{ 'A', 'V', 'T', 'o', 'L', 'r', '.', '1', ' ' };
+
+// @brief The first column of a glyph within the fixed width Font data
+template <std::size_t FONT_SIZE>
+uint8_t glyph_offset (const ssd1306::Font<FONT_SIZE> &, std::size_t)
+{
+  return 0;
+}
+
+// @brief The first inked column of a glyph within the fixed width Font data
+template <std::size_t FONT_SIZE>
+uint8_t glyph_offset (const ssd1306::ProportionalFont<FONT_SIZE> &, std::size_t glyph_idx)
+{
+  return ssd1306::ProportionalFont<FONT_SIZE>::m_glyphs[glyph_idx].offset;
+}
+
+// @brief Read one pixel of a glyph from the row-major Font data, as the original renderer did
+// @param glyph_idx
+// @param col the column within the fixed width glyph
+// @param row
+// @return true for a foreground pixel
+template <std::size_t FONT_SIZE>
+bool glyph_pixel (std::size_t glyph_idx, uint8_t col, uint8_t row)
+{
+  uint32_t bit_line{0};
+  ssd1306::Font<FONT_SIZE>::get_pixel (glyph_idx * ssd1306::Font<FONT_SIZE>::height () + row, bit_line);
+  return (bit_line << col) & 0x8000;
+}
+
+// @brief Reference version of CommonFunctions::write_char(): one draw_pixel() per glyph pixel
+template <template <std::size_t> class FONT, std::size_t FONT_SIZE, typename CANVAS>
+ssd1306::ErrorStatus reference_write_char (CANVAS &canvas, char ch, const FONT<FONT_SIZE> &font, ssd1306::Colour colour, bool padding, uint8_t overlap)
+{
+  const std::size_t glyph_idx = font.glyph_index (ch);
+  if (glyph_idx == ssd1306::no_glyph)
+  {
+    return ssd1306::ErrorStatus::PIXEL_OOB;
+  }
+  const uint8_t glyph_width = font.glyph_width (glyph_idx);
+  const uint8_t advance     = font.glyph_advance (glyph_idx);
+  const uint8_t offset      = glyph_offset (font, glyph_idx);
+  if (canvas.m_page_width < canvas.m_currentx + advance + (padding ? 1 : 0) || canvas.m_height < canvas.m_currenty + font.height ())
+  {
+    return ssd1306::ErrorStatus::OK;
+  }
+
+  if (padding)
+  {
+    for (uint8_t row = 0; row < font.height (); row++)
+    {
+      canvas.draw_pixel (canvas.m_currentx, canvas.m_currenty + row, ssd1306::Colour::Black);
+    }
+    canvas.m_currentx += 1;
+  }
+
+  const ssd1306::Colour background = (colour == ssd1306::Colour::White) ? ssd1306::Colour::Black : ssd1306::Colour::White;
+  for (uint8_t col = 0; col < advance; col++)
+  {
+    for (uint8_t row = 0; row < font.height (); row++)
+    {
+      if (col < glyph_width && glyph_pixel<FONT_SIZE> (glyph_idx, offset + col, row))
+      {
+        canvas.draw_pixel (canvas.m_currentx + col, canvas.m_currenty + row, colour);
+      }
+      else if (col >= overlap)
+      {
+        canvas.draw_pixel (canvas.m_currentx + col, canvas.m_currenty + row, background);
+      }
+    }
+  }
+  canvas.m_currentx += advance + (padding ? 1 : 0);
+  return ssd1306::ErrorStatus::OK;
+}
+
+// @brief Reference version of CommonFunctions::write_string()
+template <typename FONT, typename CANVAS>
+ssd1306::ErrorStatus reference_write_string (CANVAS &canvas, noarch::containers::StaticString<max_text_length> &msg, const FONT &font, ssd1306::Colour colour, bool padding)
+{
+  char previous{0};
+  for (char c : msg.array ())
+  {
+    if (c == '\0')
+    {
+      break;
+    }
+    uint8_t overlap{0};
+    if (!padding && previous != 0)
+    {
+      const int adjust = font.kerning (previous, c);
+      overlap          = (adjust < 0) ? std::min<int> (canvas.m_currentx, -adjust) : 0;
+      canvas.m_currentx += (adjust < 0) ? -overlap : adjust;
+    }
+    const ssd1306::ErrorStatus res = reference_write_char (canvas, c, font, colour, padding, overlap);
+    if (res != ssd1306::ErrorStatus::OK)
+    {
+      return res;
+    }
+    previous = c;
+  }
+  return ssd1306::ErrorStatus::OK;
+}
+
+// @brief One randomly generated rendering
+struct FuzzCase
+{
+  // @brief 0-4 the fixed width fonts, 5-9 the proportional fonts, smallest first
+  uint8_t font;
+  // @brief false for 128x64, true for 72x40
+  bool small_panel;
+  uint8_t x;
+  uint8_t y;
+  ssd1306::Colour colour;
+  bool padding;
+  // @brief Zero terminated unless all max_text_length characters are used
+  std::array<char, max_text_length> text;
+  // @brief Seeds the buffer contents before rendering
+  uint32_t buffer_seed;
+};
+
+// @brief Generate a case. The same seed and case number always give the same case.
+// @param seed
+// @param case_number
+// @return FuzzCase
+FuzzCase make_case (uint64_t seed, uint64_t case_number)
+{
+  // a small generator: the Mersenne Twister state alone is over the stack usage limit
+  const uint64_t mixed = seed ^ (case_number * 0x9E3779B97F4A7C15ULL);
+  std::minstd_rand rng{ static_cast<uint32_t> (mixed ^ (mixed >> 32)) };
+  FuzzCase fuzz_case{};
+  fuzz_case.font        = rng () % 10;
+  fuzz_case.small_panel = rng () % 4 == 0;
+  fuzz_case.x           = rng () % (fuzz_case.small_panel ? 72 : 128);
+  fuzz_case.y           = rng () % (fuzz_case.small_panel ? 40 : 64);
+  fuzz_case.colour      = (rng () % 2) ? ssd1306::Colour::White : ssd1306::Colour::Black;
+  fuzz_case.padding     = rng () % 2;
+
+  // mostly printable ASCII, some kerned pairs and the odd character without a glyph
+  const std::size_t length = 1 + rng () % max_text_length;
+  for (std::size_t idx = 0; idx < length; idx++)
+  {
+    switch (rng () % 8)
+    {
+      case 0:
+      case 1: fuzz_case.text[idx] = kerned_characters[rng () % kerned_characters.size ()]; break;
+      case 2:
+        if (rng () % 8 == 0)
+        {
+          fuzz_case.text[idx] = static_cast<char> ((rng () % 2) ? rng () % 32 + 1 : rng () % 128 + 127);
+          break;
+        }
+        [[fallthrough]];
+      default: fuzz_case.text[idx] = static_cast<char> (' ' + rng () % 95); break;
+    }
+  }
+  fuzz_case.buffer_seed = static_cast<uint32_t> (rng ());
+  return fuzz_case;
+}
+
+// @brief Describe a case for the test report
+// @param fuzz_case
+// @return std::string
+std::string describe (const FuzzCase &fuzz_case)
+{
+  static const std::array<const char *, 10> font_names{ "Font5x5", "Font5x7", "Font7x10", "Font11x18", "Font16x26",
+    "Font5x5Proportional", "Font5x7Proportional", "Font7x10Proportional", "Font11x18Proportional", "Font16x26Proportional" };
+  std::string text;
+  for (char c : fuzz_case.text)
+  {
+    if (c == '\0')
+    {
+      break;
+    }
+    text += (c >= ' ' && c <= '~') ? std::string (1, c) : "\\x" + std::to_string (static_cast<unsigned char> (c));
+  }
+  return std::string (font_names[fuzz_case.font]) + (fuzz_case.small_panel ? " 72x40" : " 128x64") + " at " + std::to_string (fuzz_case.x) + "," +
+         std::to_string (fuzz_case.y) + ((fuzz_case.colour == ssd1306::Colour::White) ? " white" : " black") +
+         (fuzz_case.padding ? " padded" : "") + " \"" + text + "\"";
+}
+
+// @brief Render a case with both renderers and compare the results
+// @tparam GEOMETRY
+// @tparam FONT
+// @param fuzz_case
+// @param font
+// @param optimized the canvas for CommonFunctions::write_string()
+// @param reference the canvas for the reference renderer
+// @return true if the buffers, cursors, return values match and the dirty spans cover every changed pixel
+template <typename GEOMETRY, typename FONT>
+bool renders_identically (const FuzzCase &fuzz_case, const FONT &font, Canvas<GEOMETRY> &optimized, Canvas<GEOMETRY> &reference)
+{
+  std::minstd_rand rng{ fuzz_case.buffer_seed };
+  std::generate (optimized.m_buffer.begin (), optimized.m_buffer.end (), [&rng] { return static_cast<uint8_t> (rng ()); });
+  std::copy (optimized.m_buffer.begin (), optimized.m_buffer.end (), reference.m_buffer.begin ());
+
+  noarch::containers::StaticString<max_text_length> msg{ fuzz_case.text };
+  for (Canvas<GEOMETRY> *canvas : { &optimized, &reference })
+  {
+    canvas->clear_dirty ();
+    canvas->set_cursor (fuzz_case.x, fuzz_case.y);
+  }
+  const ssd1306::ErrorStatus optimized_res = optimized.write_string (msg, font, fuzz_case.colour, fuzz_case.padding);
+  const ssd1306::ErrorStatus reference_res = reference_write_string (reference, msg, font, fuzz_case.colour, fuzz_case.padding);
+
+  if (optimized_res != reference_res || optimized.m_currentx != reference.m_currentx || optimized.m_currenty != reference.m_currenty ||
+      !std::equal (optimized.m_buffer.begin (), optimized.m_buffer.end (), reference.m_buffer.begin ()))
+  {
+    return false;
+  }
+
+  // the optimized path marks whole glyph rectangles, so its spans may be wider
+  for (uint8_t page = 0; page < GEOMETRY::height / 8; page++)
+  {
+    if (reference.is_dirty (page) &&
+        (optimized.dirty_span (page).first > reference.dirty_span (page).first || optimized.dirty_span (page).last < reference.dirty_span (page).last))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// @brief The canvases of one worker thread, on the heap to keep the worker stack small
+struct Canvases
+{
+  Canvas<ssd1306::Geometry128x64> optimized;
+  Canvas<ssd1306::Geometry128x64> reference;
+  Canvas<ssd1306::Geometry72x40> small_optimized;
+  Canvas<ssd1306::Geometry72x40> small_reference;
+};
+
+// @brief Run a case with its font
+// @param fuzz_case
+// @param canvases
+// @return true if both renderers agree
+template <typename FONT>
+bool run_case (const FuzzCase &fuzz_case, const FONT &font, Canvases &canvases)
+{
+  return fuzz_case.small_panel ? renders_identically (fuzz_case, font, canvases.small_optimized, canvases.small_reference)
+                               : renders_identically (fuzz_case, font, canvases.optimized, canvases.reference);
+}
+
+// @brief Run a case
+// @param fuzz_case
+// @param canvases
+// @return true if both renderers agree
+bool run_case (const FuzzCase &fuzz_case, Canvases &canvases)
+{
+  static const ssd1306::Font5x5Proportional font5x5_proportional{ kerning };
+  static const ssd1306::Font5x7Proportional font5x7_proportional{ kerning };
+  static const ssd1306::Font7x10Proportional font7x10_proportional{ kerning };
+  static const ssd1306::Font11x18Proportional font11x18_proportional{ kerning };
+  static const ssd1306::Font16x26Proportional font16x26_proportional{ kerning };
+  switch (fuzz_case.font)
+  {
+    case 0: return run_case (fuzz_case, ssd1306::Font5x5{}, canvases);
+    case 1: return run_case (fuzz_case, ssd1306::Font5x7{}, canvases);
+    case 2: return run_case (fuzz_case, ssd1306::Font7x10{}, canvases);
+    case 3: return run_case (fuzz_case, ssd1306::Font11x18{}, canvases);
+    case 4: return run_case (fuzz_case, ssd1306::Font16x26{}, canvases);
+    case 5: return run_case (fuzz_case, font5x5_proportional, canvases);
+    case 6: return run_case (fuzz_case, font5x7_proportional, canvases);
+    case 7: return run_case (fuzz_case, font7x10_proportional, canvases);
+    case 8: return run_case (fuzz_case, font11x18_proportional, canvases);
+    default: return run_case (fuzz_case, font16x26_proportional, canvases);
+  }
+}
+
+// @brief The number of cases to run
+// @return uint64_t SSD1306_FUZZ_CASES or default_fuzz_cases
+uint64_t fuzz_case_count ()
+{
+  const char *cases = std::getenv ("SSD1306_FUZZ_CASES");
+  return (cases != nullptr) ? std::strtoull (cases, nullptr, 10) : default_fuzz_cases;
+}
+
+} // namespace
+
+TEST_CASE ("Differential rendering", "[ssd1306_fuzz]")
+{
+  const uint64_t seed       = Catch::rngSeed ();
+  const uint64_t case_count = fuzz_case_count ();
+
+  // a pool of one worker per core, each taking the next block of cases until none are left.
+  // Catch2 assertions are not thread safe, so the workers only count failures and keep the first one.
+  constexpr uint64_t block_size{256};
+  std::atomic<uint64_t> next_case{0};
+  std::atomic<uint64_t> failures{0};
+  std::atomic<uint64_t> first_failure{UINT64_MAX};
+  const auto worker = [&] {
+    auto canvases = std::make_unique<Canvases> ();
+    for (uint64_t block = next_case.fetch_add (block_size); block < case_count; block = next_case.fetch_add (block_size))
+    {
+      for (uint64_t case_number = block; case_number < std::min (block + block_size, case_count); case_number++)
+      {
+        if (!run_case (make_case (seed, case_number), *canvases))
+        {
+          failures++;
+          uint64_t first = first_failure.load ();
+          while (case_number < first && !first_failure.compare_exchange_weak (first, case_number))
+          {
+          }
+        }
+      }
+    }
+  };
+
+  std::vector<std::thread> pool (std::max (1U, std::thread::hardware_concurrency ()));
+  for (std::thread &thread : pool)
+  {
+    thread = std::thread (worker);
+  }
+  for (std::thread &thread : pool)
+  {
+    thread.join ();
+  }
+
+  INFO ("seed " << seed << ", " << failures.load () << " of " << case_count << " cases differ");
+  INFO ("first differing case: " << ((failures.load () != 0) ? std::to_string (first_failure.load ()) + " " + describe (make_case (seed, first_failure.load ())) : "none"));
+  REQUIRE (failures.load () == 0);
+}
@@ -0,0 +1,93 @@
+// MIT License
+
+// Copyright (c) 2022 Chris Sutton
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+#include <catch2/catch_all.hpp>
+#include <mock.hpp>
+#include <optional>
+#include <ssd1306.hpp>
+
+#if defined(SSD1306_TRACE)
+TEST_CASE ("Tracing", "[ssd1306]")
+{
+  using ssd1306::trace::TracePhase;
+  using ssd1306::trace::TracePoint;
+  using ssd1306::trace::TraceRecord;
+
+  ssd1306::DriverSerialInterface<STM32G0_ISR> ssd1306_spi_interface (
+      SPI1, std::make_pair (GPIOA, GPIO_BSRR_BS0), // PA0 - DC
+      std::make_pair (GPIOA, GPIO_BSRR_BS3),       // PA3 - Reset
+      STM32G0_ISR::dma1_ch2);
+
+  ssd1306::Driver<STM32G0_ISR> d{
+    ssd1306_spi_interface, ssd1306::Driver<STM32G0_ISR>::SPIDMA::enabled
+  };
+  REQUIRE (d.power_on_sequence ());
+  d.dma_isr ();
+  ssd1306::trace::trace_buffer.clear ();
+
+  noarch::containers::StaticString<2> msg;
+  msg.array ()[0] = '1';
+  msg.array ()[1] = '2';
+  ssd1306::Font5x7 font;
+  REQUIRE (d.write (msg, font, 0, 0, ssd1306::Colour::Black, ssd1306::Colour::White, false, true) == ssd1306::ErrorStatus::OK);
+  d.dma_isr ();
+
+  static const std::array<std::pair<TracePoint, TracePhase>, 11> expected{ {
+      { TracePoint::write, TracePhase::begin },
+      { TracePoint::write_string, TracePhase::begin },
+      { TracePoint::write_char, TracePhase::begin },
+      { TracePoint::write_char, TracePhase::end },
+      { TracePoint::write_char, TracePhase::begin },
+      { TracePoint::write_char, TracePhase::end },
+      { TracePoint::write_string, TracePhase::end },
+      { TracePoint::update_screen, TracePhase::begin },
+      { TracePoint::update_screen, TracePhase::end },
+      { TracePoint::write, TracePhase::end },
+      { TracePoint::transfer_complete, TracePhase::instant },
+  } };
+  TraceRecord record;
+  std::optional<uint32_t> previous;
+  for (const auto &[point, phase] : expected)
+  {
+    REQUIRE (ssd1306::trace::trace_buffer.pop (record));
+    REQUIRE (record.point == point);
+    REQUIRE (record.phase == phase);
+    // the timestamps wrap, so only the distance between consecutive records is ordered
+    REQUIRE (record.timestamp - previous.value_or (record.timestamp) < 0x80000000u);
+    previous = record.timestamp;
+  }
+  REQUIRE_FALSE (ssd1306::trace::trace_buffer.pop (record));
+
+  // the oldest records are overwritten
+  for (std::size_t idx = 0; idx < SSD1306_TRACE_DEPTH + 5; idx++)
+  {
+    d.fill (ssd1306::Colour::Black);
+  }
+  std::size_t records{0};
+  while (ssd1306::trace::trace_buffer.pop (record))
+  {
+    records++;
+  }
+  REQUIRE (records == SSD1306_TRACE_DEPTH);
+  REQUIRE (ssd1306::trace::trace_buffer.dropped () == SSD1306_TRACE_DEPTH + 10);
+}
+#endif
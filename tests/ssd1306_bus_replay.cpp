@@ -0,0 +1,80 @@
+// MIT License
+
+// Copyright (c) 2022 Chris Sutton
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <optional>
+#include <ssd1306_bus_replay.hpp>
+#include <ssd1306_bus_trace.hpp>
+
+namespace ssd1306
+{
+
+ReplayReport replay(std::span<const uint8_t> trace, Emulator &emulator)
+{
+  ReplayReport report;
+  BusTraceReader reader{trace};
+  BusTraceRecord record;
+  ReplayFrame frame;
+  uint32_t frame_start{0};
+  std::optional<uint32_t> trace_start;
+  while (reader.next(record))
+  {
+    // the first timestamp is the clock at the first record, not a duration
+    if (!trace_start)
+    {
+      trace_start = record.timestamp;
+    }
+    if (record.type == BusRecordType::frame)
+    {
+      frame.ticks = record.timestamp - frame_start;
+      report.frames.push_back(frame);
+      frame = ReplayFrame{};
+      continue;
+    }
+    if (frame.transfers == 0)
+    {
+      frame_start = record.timestamp;
+    }
+    frame.transfers++;
+    report.total.transfers++;
+    for (uint8_t byte : record.bytes)
+    {
+      if (record.type == BusRecordType::commands)
+      {
+        emulator.command(byte);
+      }
+      else
+      {
+        emulator.data(byte);
+      }
+    }
+    std::size_t &frame_bytes = (record.type == BusRecordType::commands) ? frame.command_bytes : frame.data_bytes;
+    std::size_t &total_bytes = (record.type == BusRecordType::commands) ? report.total.command_bytes : report.total.data_bytes;
+    frame_bytes += record.bytes.size();
+    total_bytes += record.bytes.size();
+  }
+  report.unfinished = frame;
+  report.total.ticks = record.timestamp - trace_start.value_or(0);
+  report.valid       = reader.valid();
+  return report;
+}
+
+} // namespace ssd1306
@@ -0,0 +1,70 @@
+// MIT License
+
+// Copyright (c) 2022 Chris Sutton
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __SSD1306_BUS_REPLAY_HPP__
+#define __SSD1306_BUS_REPLAY_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <ssd1306_emulator.hpp>
+#include <vector>
+
+namespace ssd1306
+{
+
+// @brief The bus traffic of one frame of a bus trace
+struct ReplayFrame
+{
+  std::size_t command_bytes{0};
+  std::size_t data_bytes{0};
+  // @brief The number of command and data records
+  std::size_t transfers{0};
+  // @brief The clock ticks from the first record of the frame to its frame record
+  uint32_t ticks{0};
+
+  std::size_t bytes() const { return command_bytes + data_bytes; }
+};
+
+// @brief The result of replay()
+struct ReplayReport
+{
+  // @brief The trace was well formed to the end
+  bool valid{false};
+  // @brief The completed frames, in order
+  std::vector<ReplayFrame> frames;
+  // @brief Traffic after the last frame record, e.g. settings changed after the last update
+  ReplayFrame unfinished{};
+  // @brief All the traffic of the trace
+  ReplayFrame total{};
+};
+
+// @brief Feed a bus trace, see ssd1306_bus_trace.hpp, into an emulated controller.
+// The GDDRAM and registers of the emulator are left as the traffic left them.
+// @param trace The whole trace, starting with the header
+// @param emulator The controller
+// @return ReplayReport the traffic of each frame
+ReplayReport replay(std::span<const uint8_t> trace, Emulator &emulator);
+
+} // namespace ssd1306
+
+#endif // __SSD1306_BUS_REPLAY_HPP__
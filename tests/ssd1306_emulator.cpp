@@ -0,0 +1,276 @@
+// MIT License
+
+// Copyright (c) 2022 Chris Sutton
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <ssd1306_emulator.hpp>
+
+namespace ssd1306
+{
+
+void Emulator::command(uint8_t byte)
+{
+  command_bytes++;
+
+  // an argument of the pending command
+  if (m_args_needed > 0)
+  {
+    m_args[m_arg_count++] = byte;
+    if (m_arg_count == m_args_needed)
+    {
+      m_args_needed = 0;
+      execute();
+    }
+    return;
+  }
+
+  // single byte commands, the value is in the command
+  if (byte <= 0x0F)
+  {
+    if (addressing_mode == AddressingMode::page)
+    {
+      column = (column & 0xF0) | byte;
+    }
+    return;
+  }
+  if (byte <= 0x1F)
+  {
+    if (addressing_mode == AddressingMode::page)
+    {
+      column = static_cast<uint8_t>(((byte & 0x07) << 4) | (column & 0x0F));
+    }
+    return;
+  }
+  if (byte >= 0x40 && byte <= 0x7F)
+  {
+    start_line = byte & 0x3F;
+    return;
+  }
+  if (byte >= 0xB0 && byte <= 0xB7)
+  {
+    if (addressing_mode == AddressingMode::page)
+    {
+      page = byte & 0x07;
+    }
+    return;
+  }
+
+  switch (byte)
+  {
+    case 0x2E:
+      scrolling = false;
+      return;
+    case 0x2F:
+      scrolling = true;
+      return;
+    case 0xA0:
+    case 0xA1:
+      segment_remap = byte & 0x01;
+      return;
+    case 0xA4:
+    case 0xA5:
+      entire_display_on = byte & 0x01;
+      return;
+    case 0xA6:
+    case 0xA7:
+      inverse = byte & 0x01;
+      return;
+    case 0xAE:
+    case 0xAF:
+      display_on = byte & 0x01;
+      return;
+    case 0xC0:
+    case 0xC8:
+      com_scan_remap = byte & 0x08;
+      return;
+    case 0xE3:
+      return;
+    default:
+      break;
+  }
+
+  // commands with arguments
+  uint8_t args_needed{0};
+  switch (byte)
+  {
+    case 0x20: // memory addressing mode
+    case 0x81: // contrast
+    case 0x8D: // charge pump
+    case 0xA8: // multiplex ratio
+    case 0xD3: // display offset
+    case 0xD5: // clock divide ratio
+    case 0xD9: // pre-charge period
+    case 0xDA: // COM pins
+    case 0xDB: // VCOMH deselect level
+      args_needed = 1;
+      break;
+    case 0x21: // column address
+    case 0x22: // page address
+    case 0xA3: // vertical scroll area
+      args_needed = 2;
+      break;
+    case 0x29: // vertical and right horizontal scroll
+    case 0x2A: // vertical and left horizontal scroll
+      args_needed = 5;
+      break;
+    case 0x26: // right horizontal scroll
+    case 0x27: // left horizontal scroll
+      args_needed = 6;
+      break;
+    default:
+      unknown_commands++;
+      return;
+  }
+  m_pending     = byte;
+  m_arg_count   = 0;
+  m_args_needed = args_needed;
+}
+
+void Emulator::execute()
+{
+  switch (m_pending)
+  {
+    case 0x20:
+      addressing_mode = static_cast<AddressingMode>(m_args[0] & 0x03);
+      break;
+    case 0x21:
+      column_start = m_args[0] & 0x7F;
+      column_end   = m_args[1] & 0x7F;
+      column       = column_start;
+      break;
+    case 0x22:
+      page_start = m_args[0] & 0x07;
+      page_end   = m_args[1] & 0x07;
+      page       = page_start;
+      break;
+    case 0x26:
+    case 0x27:
+    case 0x29:
+    case 0x2A:
+      scroll_command    = m_pending;
+      scroll_start_page = m_args[1] & 0x07;
+      scroll_interval   = m_args[2] & 0x07;
+      scroll_end_page   = m_args[3] & 0x07;
+      break;
+    case 0x81:
+      contrast = m_args[0];
+      break;
+    case 0x8D:
+      charge_pump = m_args[0] & 0x04;
+      break;
+    case 0xA8:
+      mux_ratio = m_args[0] & 0x3F;
+      break;
+    case 0xD3:
+      display_offset = m_args[0] & 0x3F;
+      break;
+    case 0xDA:
+      com_pins = m_args[0];
+      break;
+    default:
+      // timing and scroll area settings do not change the picture
+      break;
+  }
+}
+
+void Emulator::data(uint8_t byte)
+{
+  data_bytes++;
+  if (scrolling)
+  {
+    writes_while_scrolling++;
+  }
+  gddram[page][column] = byte;
+
+  switch (addressing_mode)
+  {
+    case AddressingMode::page:
+      // the page does not change, see section 10.1.3 of datasheet
+      column = (column == column_end) ? column_start : column + 1;
+      break;
+    case AddressingMode::horizontal:
+      if (column == column_end)
+      {
+        column = column_start;
+        page   = (page == page_end) ? page_start : page + 1;
+      }
+      else
+      {
+        column++;
+      }
+      break;
+    case AddressingMode::vertical:
+      if (page == page_end)
+      {
+        page   = page_start;
+        column = (column == column_end) ? column_start : column + 1;
+      }
+      else
+      {
+        page++;
+      }
+      break;
+  }
+}
+
+void Emulator::reset()
+{
+  addressing_mode   = AddressingMode::page;
+  column            = 0;
+  page              = 0;
+  column_start      = 0;
+  column_end        = m_columns - 1;
+  page_start        = 0;
+  page_end          = m_pages - 1;
+  start_line        = 0;
+  display_offset    = 0;
+  mux_ratio         = m_rows - 1;
+  com_pins          = 0x12;
+  segment_remap     = false;
+  com_scan_remap    = false;
+  contrast          = 0x7F;
+  inverse           = false;
+  entire_display_on = false;
+  display_on        = false;
+  charge_pump       = false;
+  scrolling         = false;
+  m_args_needed     = 0;
+}
+
+bool Emulator::pixel(uint8_t x, uint8_t y) const
+{
+  if (!display_on || x >= m_columns || y > mux_ratio)
+  {
+    return false;
+  }
+  if (entire_display_on)
+  {
+    return true;
+  }
+
+  // the panel row is driven by a COM line, which shows a GDDRAM row
+  const uint8_t com     = com_scan_remap ? mux_ratio - y : y;
+  const uint8_t ram_row = (com + display_offset + start_line) % m_rows;
+  const uint8_t ram_col = segment_remap ? m_columns - 1 - x : x;
+  const bool lit        = gddram[ram_row / 8][ram_col] & (1 << (ram_row % 8));
+  return lit != inverse;
+}
+
+} // namespace ssd1306
@@ -0,0 +1,160 @@
+// MIT License
+
+// Copyright (c) 2022 Chris Sutton
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __SSD1306_EMULATOR_HPP__
+#define __SSD1306_EMULATOR_HPP__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace ssd1306
+{
+
+// @brief Host model of the SSD1306 controller. Decodes the command and data byte stream
+// into a simulated GDDRAM and the register settings. See section 10 of datasheet.
+class Emulator
+{
+public:
+  static constexpr uint8_t m_columns{128};
+  static constexpr uint8_t m_pages{8};
+  static constexpr uint8_t m_rows{64};
+
+  enum class AddressingMode : uint8_t
+  {
+    horizontal = 0x00,
+    vertical   = 0x01,
+    page       = 0x02
+  };
+
+  // @brief Decode one command byte, or an argument of the previous command
+  // @param byte The byte sent with DC low
+  void command(uint8_t byte);
+
+  // @brief Write one byte to GDDRAM at the address pointer, then advance the pointer
+  // @param byte The byte sent with DC high
+  void data(uint8_t byte);
+
+  // @brief Back to the register reset values. GDDRAM is not cleared by a reset, and the byte counters are kept.
+  void reset();
+
+  // @brief The pixel shown at a panel position, after start line, display offset, remapping,
+  // inversion and entire display on
+  // @param x The segment, i.e. the GDDRAM column before remapping
+  // @param y The panel row
+  // @return true if the pixel is lit
+  bool pixel(uint8_t x, uint8_t y) const;
+
+  // @brief The GDDRAM
+  std::array<std::array<uint8_t, m_columns>, m_pages> gddram{};
+
+  AddressingMode addressing_mode{AddressingMode::page};
+  // @brief The address pointer
+  uint8_t column{0};
+  uint8_t page{0};
+  // @brief The horizontal and vertical addressing window
+  uint8_t column_start{0};
+  uint8_t column_end{m_columns - 1};
+  uint8_t page_start{0};
+  uint8_t page_end{m_pages - 1};
+
+  uint8_t start_line{0};
+  uint8_t display_offset{0};
+  uint8_t mux_ratio{m_rows - 1};
+  uint8_t com_pins{0x12};
+  bool segment_remap{false};
+  bool com_scan_remap{false};
+  uint8_t contrast{0x7F};
+  bool inverse{false};
+  bool entire_display_on{false};
+  bool display_on{false};
+  bool charge_pump{false};
+
+  bool scrolling{false};
+  // @brief The last scroll setup command, 0x26, 0x27, 0x29 or 0x2A
+  uint8_t scroll_command{0};
+  uint8_t scroll_start_page{0};
+  uint8_t scroll_end_page{0};
+  uint8_t scroll_interval{0};
+
+  // @brief The number of command and data bytes received
+  std::size_t command_bytes{0};
+  std::size_t data_bytes{0};
+  // @brief Command bytes that are not in the SSD1306 command set
+  std::size_t unknown_commands{0};
+  // @brief GDDRAM writes while scrolling, which the datasheet does not allow
+  std::size_t writes_while_scrolling{0};
+
+private:
+  // @brief The command waiting for its arguments
+  uint8_t m_pending{0};
+  // @brief The arguments received so far, and the number the pending command needs
+  std::array<uint8_t, 6> m_args{};
+  uint8_t m_arg_count{0};
+  uint8_t m_args_needed{0};
+
+  // @brief Apply a command once all its arguments have been received
+  void execute();
+};
+
+// @brief Transport policy for Driver that feeds an Emulator, see ssd1306_transport.hpp
+class EmulatorTransport
+{
+public:
+  static constexpr bool spi_capable{false};
+
+  // @brief Construct a new EmulatorTransport object
+  // @param emulator The controller that receives the bytes
+  explicit EmulatorTransport(Emulator &emulator)
+      : m_emulator(&emulator)
+  {
+  }
+
+  void begin() {}
+
+  void hardware_reset() { m_emulator->reset(); }
+
+  bool send_commands(const uint8_t *cmd_bytes, std::size_t count)
+  {
+    for (std::size_t idx = 0; idx < count; idx++)
+    {
+      m_emulator->command(cmd_bytes[idx]);
+    }
+    return true;
+  }
+
+  bool send_data(const uint8_t *data_bytes, std::size_t length)
+  {
+    for (std::size_t idx = 0; idx < length; idx++)
+    {
+      m_emulator->data(data_bytes[idx]);
+    }
+    return true;
+  }
+
+private:
+  Emulator *m_emulator;
+};
+
+} // namespace ssd1306
+
+#endif // __SSD1306_EMULATOR_HPP__
@@ -0,0 +1,79 @@
+// MIT License
+
+// Copyright (c) 2022 Chris Sutton
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __SSD1306_EMULATOR_SPI_HPP__
+#define __SSD1306_EMULATOR_SPI_HPP__
+
+#include <ssd1306_emulator.hpp>
+#include <ssd1306_transport.hpp>
+
+namespace ssd1306
+{
+
+// @brief SPI transport policy for Driver that also feeds an Emulator, see ssd1306_transport.hpp.
+// EmulatorTransport is not spi_capable, so it only sees the polled transfers. This one keeps the mocked SPI peripheral,
+// so every Driver::SPIDMA mode runs, and feeds the emulator from record_commands() and record_data(): the Driver passes
+// them every burst wherever it is sent from, the CPU, DMA or the SPI interrupt.
+// The emulator is fed when a transfer starts, so it is up to date before dma_isr() or spi_isr() are called.
+// @tparam DEVICE_ISR_ENUM The interrupt type enum of the MCU, see stm32_interrupt_managers
+template <typename DEVICE_ISR_ENUM>
+class EmulatorSpiTransport : public SpiTransport<DEVICE_ISR_ENUM>
+{
+public:
+  // @brief Construct a new EmulatorSpiTransport object
+  // @param serial_interface The mocked SPI peripheral, DC and reset pins, and interrupts
+  // @param emulator The controller that receives the bytes
+  EmulatorSpiTransport(const DriverSerialInterface<DEVICE_ISR_ENUM> &serial_interface, Emulator &emulator)
+      : SpiTransport<DEVICE_ISR_ENUM>(serial_interface),
+        m_emulator(&emulator)
+  {
+  }
+
+  void hardware_reset()
+  {
+    SpiTransport<DEVICE_ISR_ENUM>::hardware_reset();
+    m_emulator->reset();
+  }
+
+  void record_commands(const uint8_t *cmd_bytes, std::size_t count)
+  {
+    for (std::size_t idx = 0; idx < count; idx++)
+    {
+      m_emulator->command(cmd_bytes[idx]);
+    }
+  }
+
+  void record_data(const uint8_t *data_bytes, std::size_t length)
+  {
+    for (std::size_t idx = 0; idx < length; idx++)
+    {
+      m_emulator->data(data_bytes[idx]);
+    }
+  }
+
+private:
+  Emulator *m_emulator;
+};
+
+} // namespace ssd1306
+
+#endif // __SSD1306_EMULATOR_SPI_HPP__
@@ -0,0 +1,166 @@
+// MIT License
+
+// Copyright (c) 2022 Chris Sutton
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Replays a bus trace recorded with RecordingTransport into the emulator and reports the bytes sent per frame and the
+// final GDDRAM. Given a second, baseline trace, e.g. recorded before a change, reports the difference per frame.
+// Usage: ssd1306_replay <trace> [<baseline trace>]
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <memory>
+#include <ssd1306_bus_replay.hpp>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// @brief Read a whole file
+// @param path
+// @param bytes The file contents
+// @return true if the file was read
+bool read_file(const char *path, std::vector<uint8_t> &bytes)
+{
+  std::FILE *file = std::fopen(path, "rb");
+  if (file == nullptr)
+  {
+    return false;
+  }
+  std::array<uint8_t, 512> chunk;
+  std::size_t length{0};
+  while ((length = std::fread(chunk.data(), 1, chunk.size(), file)) > 0)
+  {
+    bytes.insert(bytes.end(), chunk.begin(), chunk.begin() + length);
+  }
+  const bool ok = !std::ferror(file);
+  std::fclose(file);
+  return ok;
+}
+
+// @brief Replay a trace file into an emulator
+// @param path
+// @param emulator
+// @param report
+// @return true if the file was read and is a well formed trace
+bool replay_file(const char *path, ssd1306::Emulator &emulator, ssd1306::ReplayReport &report)
+{
+  std::vector<uint8_t> trace;
+  if (!read_file(path, trace))
+  {
+    std::fprintf(stderr, "%s: cannot read\n", path);
+    return false;
+  }
+  report = ssd1306::replay(trace, emulator);
+  if (!report.valid)
+  {
+    std::fprintf(stderr, "%s: not a bus trace, or truncated after %zu frames\n", path, report.frames.size());
+    return false;
+  }
+  return true;
+}
+
+void print_frame(const char *label, const ssd1306::ReplayFrame &frame)
+{
+  std::printf("%-10s %8zu %8zu %8zu %10u\n", label, frame.bytes(), frame.command_bytes, frame.data_bytes, frame.ticks);
+}
+
+void print_report(const ssd1306::ReplayReport &report)
+{
+  std::printf("%-10s %8s %8s %8s %10s\n", "frame", "bytes", "command", "data", "ticks");
+  for (std::size_t idx = 0; idx < report.frames.size(); idx++)
+  {
+    print_frame(std::to_string(idx).c_str(), report.frames[idx]);
+  }
+  if (report.unfinished.transfers > 0)
+  {
+    print_frame("unfinished", report.unfinished);
+  }
+  print_frame("total", report.total);
+}
+
+void print_gddram(const ssd1306::Emulator &emulator)
+{
+  std::printf("\nGDDRAM\n");
+  for (uint8_t page = 0; page < ssd1306::Emulator::m_pages; page++)
+  {
+    std::printf("page %u:", page);
+    for (uint8_t col = 0; col < ssd1306::Emulator::m_columns; col++)
+    {
+      if (col > 0 && col % 32 == 0)
+      {
+        std::printf("\n       ");
+      }
+      std::printf(" %02x", emulator.gddram[page][col]);
+    }
+    std::printf("\n");
+  }
+}
+
+// @brief Compare a trace with a baseline trace, frame by frame
+void print_comparison(const ssd1306::ReplayReport &report, const ssd1306::ReplayReport &baseline, bool same_gddram)
+{
+  std::printf("\n%-10s %8s %8s %8s\n", "frame", "baseline", "bytes", "change");
+  const std::size_t frames = std::max(report.frames.size(), baseline.frames.size());
+  for (std::size_t idx = 0; idx < frames; idx++)
+  {
+    const std::size_t before = (idx < baseline.frames.size()) ? baseline.frames[idx].bytes() : 0;
+    const std::size_t after  = (idx < report.frames.size()) ? report.frames[idx].bytes() : 0;
+    std::printf("%-10zu %8zu %8zu %+8td\n", idx, before, after, static_cast<std::ptrdiff_t>(after - before));
+  }
+  std::printf("%-10s %8zu %8zu %+8td\n", "total", baseline.total.bytes(), report.total.bytes(),
+              static_cast<std::ptrdiff_t>(report.total.bytes() - baseline.total.bytes()));
+  std::printf("\nfinal GDDRAM %s the baseline\n", same_gddram ? "matches" : "differs from");
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+  if (argc < 2 || argc > 3)
+  {
+    std::fprintf(stderr, "usage: %s <trace> [<baseline trace>]\n", argv[0]);
+    return 2;
+  }
+
+  // the emulators are too large for the stack usage limit
+  auto emulator = std::make_unique<ssd1306::Emulator>();
+  ssd1306::ReplayReport report;
+  if (!replay_file(argv[1], *emulator, report))
+  {
+    return 1;
+  }
+  print_report(report);
+
+  if (argc == 3)
+  {
+    auto baseline_emulator = std::make_unique<ssd1306::Emulator>();
+    ssd1306::ReplayReport baseline;
+    if (!replay_file(argv[2], *baseline_emulator, baseline))
+    {
+      return 1;
+    }
+    print_comparison(report, baseline, emulator->gddram == baseline_emulator->gddram);
+  }
+  print_gddram(*emulator);
+  return 0;
+}